@@ -0,0 +1,596 @@
+#define _POSIX_C_SOURCE 199309L
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "microui.h"
+#include "swrender.h"
+#include "swkernels.h"
+#include "swtiles.h"
+#include "inputlog.h"
+#include "cmdstream.h"
+
+/*
+** Drives mu_begin()/mu_end() headlessly over synthetic scenes and prints one
+** JSON object per scene on stdout. Run without arguments for the built-in
+** suite, or give a single scene on the command line, eg:
+**
+**   ./bench --windows 8 --widgets 200 --frames 2000 --render --cache
+**
+** `--record <file>` saves each frame's input and `--replay <file>` drives a
+** scene from a saved log instead of the synthetic mouse sweep, running until
+** the log ends. `--kernels <name>` renders with the given span kernels (eg.
+** `scalar`) instead of the best the CPU supports, and `--render-threads <n>`
+** rasterizes each frame in tiles on that many threads. `--stream` encodes
+** every frame with the command stream, decodes it again and fails if any
+** decoded command differs, reporting the bytes of key and delta frames.
+*/
+
+typedef struct {
+  const char *name;
+  int windows;   /* number of root windows */
+  int widgets;   /* widgets per window */
+  int depth;     /* depth of nested, expanded treenodes per window */
+  int text_len;  /* bytes of wordwrapped `mu_text` per window */
+  int labels;    /* labels in a small scrolled panel (mostly clipped) */
+  int frames;
+  int render;    /* also rasterize each frame with the software renderer */
+  int cache;     /* enable the context's text width cache */
+  int clipper;   /* process the scrolled labels through a `mu_Clipper` */
+  int retained;  /* begin windows with `mu_begin_window_cached` */
+  int table;     /* rows of a 32 column `mu_table` per window */
+  int threads;   /* build the windows on this many sub-contexts in parallel */
+  int render_threads; /* rasterize in tiles on this many threads */
+  int wrap_cache; /* cache the line breaks of `mu_text` */
+  int editor;    /* bytes of text in a `mu_textedit` per window, typed into */
+  int log;       /* lines appended per frame to a `mu_log_view` per window */
+  const char *log_filter; /* substring the log is filtered for */
+  int stream;    /* round-trip each frame through the command stream */
+  const char *record; /* input log to write */
+  const char *replay; /* input log to read */
+} Scene;
+
+typedef struct {
+  mu_Context *ctx;
+  Scene *scene;
+  int first, last;
+} Job;
+
+#define MAX_THREADS 16
+
+static Scene suite[] = {
+  { .name = "empty", .windows = 1, .frames = 20000 },
+  { .name = "widgets", .windows = 4, .widgets = 100, .frames = 5000 },
+  { .name = "many_windows", .windows = 24, .widgets = 20, .frames = 2000 },
+  { .name = "deep_tree", .windows = 1, .depth = 24, .frames = 5000 },
+  { .name = "long_text", .windows = 1, .text_len = 50000, .frames = 500 },
+  { .name = "clipped", .windows = 1, .labels = 10000, .frames = 500 },
+  { .name = "dashboard", .windows = 6, .widgets = 60, .depth = 8,
+    .text_len = 2000, .labels = 500, .frames = 1000, .render = 1 },
+  { .name = "long_text_cached", .windows = 1, .text_len = 50000, .frames = 500,
+    .cache = 1 },
+  { .name = "dashboard_cached", .windows = 6, .widgets = 60, .depth = 8,
+    .text_len = 2000, .labels = 500, .frames = 1000, .render = 1, .cache = 1 },
+  { .name = "clipped_clipper", .windows = 1, .labels = 10000, .frames = 500,
+    .clipper = 1 },
+  { .name = "many_windows_retained", .windows = 24, .widgets = 20,
+    .frames = 2000, .retained = 1 },
+  { .name = "dashboard_retained", .windows = 6, .widgets = 60, .depth = 8,
+    .text_len = 2000, .labels = 500, .frames = 1000, .render = 1,
+    .retained = 1 },
+  { .name = "table", .windows = 1, .frames = 5000, .table = 1000000 },
+  { .name = "many_windows_threads", .windows = 24, .widgets = 20,
+    .frames = 2000, .threads = 4 },
+  { .name = "dashboard_threads", .windows = 6, .widgets = 60, .depth = 8,
+    .text_len = 2000, .labels = 500, .frames = 1000, .render = 1,
+    .threads = 3 },
+  { .name = "dashboard_tiled", .windows = 6, .widgets = 60, .depth = 8,
+    .text_len = 2000, .labels = 500, .frames = 1000, .render = 1,
+    .render_threads = 4 },
+  { .name = "long_text_wrapped", .windows = 1, .text_len = 50000, .frames = 500,
+    .wrap_cache = 1 },
+  { .name = "editor", .windows = 1, .frames = 2000, .editor = 4 << 20 },
+  { .name = "log", .windows = 1, .frames = 2000, .log = 1000 },
+  { .name = "log_filtered", .windows = 1, .frames = 2000, .log = 1000,
+    .log_filter = "99" },
+  { .name = "many_roots", .windows = 2000, .frames = 500 },
+  { .name = "dashboard_stream", .windows = 6, .widgets = 60, .depth = 8,
+    .text_len = 2000, .labels = 500, .frames = 1000, .stream = 1 },
+  { .name = NULL }
+};
+
+/* state of a window's controls */
+typedef struct { int checks[64]; float values[64]; } Controls;
+
+static mu_TextCache text_cache;
+static mu_WrapCache wrap_cache;
+/* one of each per window, so threads never share one */
+static Controls *controls;
+static mu_TextEdit *editors;
+static mu_Log *logs;
+static atomic_long text_width_calls;
+static atomic_long text_height_calls;
+static char *lorem;
+
+
+static int text_width(mu_Font font, const char *text, int len) {
+  atomic_fetch_add_explicit(&text_width_calls, 1, memory_order_relaxed);
+  return sw_text_width(font, text, len);
+}
+
+
+static int text_height(mu_Font font) {
+  atomic_fetch_add_explicit(&text_height_calls, 1, memory_order_relaxed);
+  return sw_text_height(font);
+}
+
+
+static void* alloc(mu_Context *ctx, void *ptr, int size) {
+  (void) ctx;
+  if (size == 0) { free(ptr); return NULL; }
+  return realloc(ptr, size);
+}
+
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static char* make_text(int len) {
+  static const char words[] =
+    "lorem ipsum dolor sit amet consectetur adipiscing elit maecenas "
+    "lacinia sem eu lacinia molestie mi risus faucibus ipsum eu varius "
+    "magna felis a nulla\n";
+  char *res = malloc(len + 1);
+  for (int i = 0; i < len; i++) { res[i] = words[i % (sizeof(words) - 1)]; }
+  res[len] = '\0';
+  return res;
+}
+
+
+static void cell(mu_Context *ctx, void *udata, int row, int col, mu_Rect r) {
+  char buf[32];
+  (void) udata;
+  sprintf(buf, "%d:%d", row, col);
+  mu_draw_control_text(ctx, buf, r, MU_COLOR_TEXT, 0);
+}
+
+
+static void tree(mu_Context *ctx, int depth) {
+  /* each treenode pushes its own id, so the same label is unique per level */
+  if (depth == 0) { return; }
+  if (mu_begin_treenode_ex(ctx, "Node", MU_OPT_EXPANDED)) {
+    mu_label(ctx, "Leaf label");
+    tree(ctx, depth - 1);
+    mu_end_treenode(ctx);
+  }
+}
+
+
+static void scene_window(mu_Context *ctx, Scene *s, int idx) {
+  Controls *c = &controls[idx];
+  char title[32], buf[32];
+  sprintf(title, "Window %d", idx);
+  mu_Rect rect = mu_rect(20 + (idx % 8) * 40, 20 + (idx / 8) * 40, 320, 480);
+  if (s->retained) {
+    if (!mu_begin_window_cached(ctx, title, rect, 0, 0)) { return; }
+  } else {
+    if (!mu_begin_window(ctx, title, rect)) { return; }
+  }
+
+  mu_layout_row(ctx, 2, (int[]) { 100, -1 }, 0);
+  for (int i = 0; i < s->widgets; i++) {
+    mu_push_id(ctx, &i, sizeof(i));
+    switch (i % 4) {
+      case 0: sprintf(buf, "Label %d", i); mu_label(ctx, buf); break;
+      case 1: mu_button(ctx, "Button"); break;
+      case 2: mu_checkbox(ctx, "Check", &c->checks[i % 64]); break;
+      case 3: mu_slider(ctx, &c->values[i % 64], 0, 100); break;
+    }
+    mu_pop_id(ctx);
+  }
+
+  if (s->depth) {
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 0);
+    tree(ctx, s->depth);
+  }
+
+  if (s->text_len) {
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 0);
+    mu_text(ctx, lorem);
+  }
+
+  if (s->labels) {
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 120);
+    mu_begin_panel(ctx, "Labels");
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 0);
+    mu_Clipper clipper = { .first = 0, .last = s->labels };
+    if (s->clipper) { mu_begin_clipper(ctx, &clipper, s->labels, 0); }
+    for (int i = clipper.first; i < clipper.last; i++) {
+      sprintf(buf, "Clipped label %d", i);
+      mu_label(ctx, buf);
+    }
+    if (s->clipper) { mu_end_clipper(ctx, &clipper); }
+    mu_end_panel(ctx);
+  }
+
+  if (s->table) {
+    static mu_Column columns[32];
+    static char labels[32][16];
+    for (int i = 0; i < 32; i++) {
+      sprintf(labels[i], "Column %d", i);
+      columns[i] = (mu_Column) { labels[i], 80 };
+    }
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 300);
+    mu_table(ctx, "Table", columns, 32, s->table, cell, NULL);
+  }
+
+  if (s->editor) {
+    /* a character typed at the cursor every frame */
+    mu_TextEdit *te = &editors[idx];
+    mu_textedit_insert(ctx, te, "x", 1);
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 300);
+    mu_textedit(ctx, te);
+  }
+
+  if (s->log) {
+    mu_Log *log = &logs[idx];
+    for (int i = 0; i < s->log; i++) {
+      sprintf(buf, "line %d of the log", log->seq + log->count);
+      mu_log_append(log, buf, -1);
+      /* the view hands lines to `text_width` as they are stored, which must
+      ** be null-terminated inside the ring */
+      mu_LogLine *line = &log->lines[(log->first + log->count - 1) %
+        log->line_cap];
+      if (line->start + line->len >= log->text_size ||
+          log->text[line->start + line->len] != '\0'
+      ) {
+        fprintf(stderr, "unterminated log line %d\n", log->seq + log->count);
+        exit(EXIT_FAILURE);
+      }
+    }
+    mu_layout_row(ctx, 1, (int[]) { -1 }, 300);
+    mu_log_view(ctx, log);
+  }
+
+  mu_end_window(ctx);
+}
+
+
+static void* build_windows(void *udata) {
+  Job *job = udata;
+  for (int i = job->first; i < job->last; i++) {
+    scene_window(job->ctx, job->scene, i);
+  }
+  return NULL;
+}
+
+
+/* an in-memory pipe between the command stream's encoder and decoder */
+typedef struct {
+  unsigned char *data;
+  int size, cap, pos;
+} Pipe;
+
+
+static int pipe_write(void *udata, const void *data, int size) {
+  Pipe *p = udata;
+  if (p->size + size > p->cap) {
+    p->cap = mu_max(p->size + size, p->cap * 2);
+    p->data = realloc(p->data, p->cap);
+  }
+  memcpy(p->data + p->size, data, size);
+  p->size += size;
+  return 1;
+}
+
+
+static int pipe_read(void *udata, void *data, int size) {
+  Pipe *p = udata;
+  if (p->pos + size > p->size) { return 0; }
+  memcpy(data, p->data + p->pos, size);
+  p->pos += size;
+  return 1;
+}
+
+
+static int same_command(mu_Command *a, mu_Command *b) {
+  if (a->type != b->type) { return 0; }
+  switch (a->type) {
+    case MU_COMMAND_CLIP:
+      return !memcmp(&a->clip.rect, &b->clip.rect, sizeof(mu_Rect));
+    case MU_COMMAND_RECT:
+      return !memcmp(&a->rect.rect, &b->rect.rect, sizeof(mu_Rect))
+        && !memcmp(&a->rect.color, &b->rect.color, sizeof(mu_Color));
+    case MU_COMMAND_ICON:
+      return a->icon.id == b->icon.id
+        && !memcmp(&a->icon.rect, &b->icon.rect, sizeof(mu_Rect))
+        && !memcmp(&a->icon.color, &b->icon.color, sizeof(mu_Color));
+    case MU_COMMAND_TEXT:
+      return a->text.font == b->text.font
+        && a->text.pos.x == b->text.pos.x && a->text.pos.y == b->text.pos.y
+        && !memcmp(&a->text.color, &b->text.color, sizeof(mu_Color))
+        && !strcmp(a->text.str, b->text.str);
+  }
+  return 0;
+}
+
+
+/* encodes the frame, decodes it again and checks the commands came back
+** unchanged; returns 0 if not */
+static int stream_frame(cs_Encoder *enc, cs_Decoder *dec, mu_Context *ctx) {
+  Pipe *p = enc->udata;
+  mu_Command *a = NULL, *b = NULL;
+  p->size = p->pos = 0;
+  if (!cs_encode(enc, ctx) || !cs_decode(dec) || p->pos != p->size) {
+    return 0;
+  }
+  for (;;) {
+    int more = mu_next_command(ctx, &a);
+    if (more != cs_next_command(dec, &b)) { return 0; }
+    if (!more) { return 1; }
+    if (!same_command(a, b)) { return 0; }
+  }
+}
+
+
+static void* init_context(mu_Context *ctx, int windows) {
+  /* scenes with more windows than `mu_init()` has room for get a context
+  ** sized for them, whose memory is returned to be freed */
+  if (windows <= MU_ROOTLIST_SIZE) {
+    mu_init(ctx);
+    return NULL;
+  }
+  mu_Config cfg = { 0 };
+  cfg.root_list_size = windows;
+  cfg.container_pool_size = windows * 2;
+  void *memory = malloc(mu_memory_size(&cfg));
+  mu_init_ex(ctx, &cfg, memory);
+  return memory;
+}
+
+
+static void run_scene(mu_Context *ctx, Scene *s) {
+  long commands[MU_COMMAND_MAX] = { 0 };
+  long total = 0, bytes = 0, changed = 0;
+  double build = 0, render = 0;
+  sw_Target target = { NULL, 1280, 720, 1280 * 4 };
+  mu_Color background = mu_color(90, 95, 100, 255);
+  sw_Tiler tiler;
+  if (s->render) { target.pixels = malloc(target.pitch * target.height); }
+  if (s->render_threads) { sw_tiler_init(&tiler, s->render_threads, 0); }
+
+  void *memory = init_context(ctx, s->windows);
+  ctx->alloc = alloc;
+  ctx->text_width = text_width;
+  ctx->text_height = text_height;
+  controls = calloc(s->windows, sizeof(Controls));
+  /* cleared for every scene, as its counters are reported by all of them */
+  memset(&text_cache, 0, sizeof(text_cache));
+  if (s->cache) { ctx->text_cache = &text_cache; }
+  if (s->wrap_cache) {
+    memset(&wrap_cache, 0, sizeof(wrap_cache));
+    ctx->wrap_cache = &wrap_cache;
+  }
+  free(lorem);
+  lorem = make_text(s->text_len);
+  if (s->editor) {
+    /* typing starts in the middle of the text */
+    char *text = make_text(s->editor);
+    editors = calloc(s->windows, sizeof(mu_TextEdit));
+    for (int i = 0; i < s->windows; i++) {
+      mu_textedit_set(ctx, &editors[i], text, s->editor);
+      editors[i].cursor = editors[i].anchor = s->editor / 2;
+    }
+    free(text);
+  }
+  if (s->log) {
+    logs = calloc(s->windows, sizeof(mu_Log));
+    for (int i = 0; i < s->windows; i++) {
+      int lines = 64 * 1024;
+      mu_log_init(&logs[i], malloc(lines * 16), lines * 16,
+        malloc(lines * sizeof(mu_LogLine)), malloc(lines * sizeof(int)), lines);
+      if (s->log_filter) { mu_log_filter(&logs[i], s->log_filter); }
+    }
+  }
+  text_width_calls = text_height_calls = 0;
+
+  mu_Context *subs[MAX_THREADS];
+  void *sub_memory[MAX_THREADS];
+  s->threads = mu_clamp(s->threads, 0, MAX_THREADS);
+  for (int i = 0; i < s->threads; i++) {
+    subs[i] = malloc(sizeof(mu_Context));
+    sub_memory[i] = init_context(subs[i], s->windows);
+    subs[i]->alloc = alloc;
+  }
+
+  Pipe pipe = { NULL };
+  cs_Encoder enc = { .write = pipe_write, .udata = &pipe,
+    .keyframe_interval = 100 };
+  cs_Decoder dec = { .read = pipe_read, .udata = &pipe };
+  long key_bytes = 0, key_frames = 0, delta_bytes = 0;
+
+  il_Log record = { NULL }, replay = { NULL };
+  if (s->record && !il_record_open(&record, s->record)) {
+    fprintf(stderr, "could not open '%s'\n", s->record);
+    exit(EXIT_FAILURE);
+  }
+  if (s->replay && !il_play_open(&replay, s->replay)) {
+    fprintf(stderr, "could not open input log '%s'\n", s->replay);
+    exit(EXIT_FAILURE);
+  }
+
+  int frames = 0;
+  for (;;) {
+    if (s->replay) {
+      if (!il_play_frame(&replay, ctx)) { break; }
+    } else {
+      if (frames == s->frames) { break; }
+      /* sweep the mouse so hover state changes between frames */
+      mu_input_mousemove(ctx, (frames * 7) % 640, (frames * 3) % 480);
+    }
+    frames++;
+
+    double t = now_ns();
+    mu_begin(ctx);
+    if (s->record) { il_record_frame(&record, ctx); }
+    if (s->threads) {
+      pthread_t threads[MAX_THREADS];
+      Job jobs[MAX_THREADS];
+      for (int i = 0; i < s->threads; i++) {
+        int first = s->windows * i / s->threads;
+        int last = s->windows * (i + 1) / s->threads;
+        jobs[i] = (Job) { subs[i], s, first, last };
+        mu_fork(ctx, subs[i]);
+        pthread_create(&threads[i], NULL, build_windows, &jobs[i]);
+      }
+      for (int i = 0; i < s->threads; i++) {
+        pthread_join(threads[i], NULL);
+        mu_join(ctx, subs[i]);
+      }
+    } else {
+      for (int i = 0; i < s->windows; i++) { scene_window(ctx, s, i); }
+    }
+    if (mu_end(ctx) & MU_FRAME_CHANGED) { changed++; }
+    build += now_ns() - t;
+
+    mu_Command *cmd = NULL;
+    while (mu_next_command(ctx, &cmd)) { commands[cmd->type]++; total++; }
+    bytes += ctx->command_list.total + ctx->command_list.idx;
+    /* the threads' segments stay in the sub-contexts' lists */
+    for (int i = 0; i < s->threads; i++) {
+      bytes += subs[i]->command_list.total + subs[i]->command_list.idx;
+    }
+
+    if (s->stream) {
+      int key = enc.frames % enc.keyframe_interval == 0;
+      if (!stream_frame(&enc, &dec, ctx)) {
+        fprintf(stderr, "command stream mismatch in frame %d\n", frames);
+        exit(EXIT_FAILURE);
+      }
+      if (key) { key_bytes += enc.last_size; key_frames++; }
+      else { delta_bytes += enc.last_size; }
+    }
+
+    if (s->render) {
+      t = now_ns();
+      if (s->render_threads) {
+        sw_tiler_render(&tiler, &target, ctx, &background);
+      } else {
+        sw_clear(&target, background);
+        sw_render(&target, ctx);
+      }
+      render += now_ns() - t;
+    }
+  }
+
+  int n = mu_max(frames, 1);
+  printf("{\"scene\":\"%s\",\"version\":\"%s\",\"windows\":%d,\"widgets\":%d,"
+    "\"depth\":%d,\"text_len\":%d,\"labels\":%d,\"frames\":%d,"
+    "\"ns_per_frame\":%.0f,\"render_ns_per_frame\":%.0f,\"kernels\":\"%s\","
+    "\"render_threads\":%d,"
+    "\"command_bytes\":%ld,\"commands\":%ld,\"rect\":%ld,\"text\":%ld,"
+    "\"icon\":%ld,\"clip\":%ld,\"text_width_calls\":%ld,"
+    "\"text_height_calls\":%ld,\"text_cache_hits\":%d,"
+    "\"text_cache_misses\":%d,\"changed_frames\":%ld,"
+    "\"stream_key_bytes\":%ld,\"stream_delta_bytes\":%ld}\n",
+    s->name, MU_VERSION, s->windows, s->widgets, s->depth, s->text_len,
+    s->labels, frames, build / n, render / n, sw_kernels()->name,
+    s->render_threads,
+    bytes / n, total / n,
+    commands[MU_COMMAND_RECT] / n, commands[MU_COMMAND_TEXT] / n,
+    commands[MU_COMMAND_ICON] / n, commands[MU_COMMAND_CLIP] / n,
+    text_width_calls / n, text_height_calls / n,
+    text_cache.hits / n, text_cache.misses / n, changed,
+    key_bytes / mu_max(key_frames, 1),
+    delta_bytes / mu_max(frames - key_frames, 1));
+  fflush(stdout);
+  free(target.pixels);
+  if (s->render_threads) { sw_tiler_deinit(&tiler); }
+  il_close(&record);
+  il_close(&replay);
+  cs_encoder_free(&enc);
+  cs_decoder_free(&dec);
+  free(pipe.data);
+  for (int i = 0; editors && i < s->windows; i++) {
+    mu_textedit_deinit(ctx, &editors[i]);
+  }
+  for (int i = 0; logs && i < s->windows; i++) {
+    free(logs[i].text);
+    free(logs[i].lines);
+    free(logs[i].matches);
+  }
+  free(controls);
+  free(editors);
+  free(logs);
+  controls = NULL;
+  editors = NULL;
+  logs = NULL;
+  mu_deinit(ctx);
+  free(memory);
+  for (int i = 0; i < s->threads; i++) {
+    mu_deinit(subs[i]);
+    free(subs[i]);
+    free(sub_memory[i]);
+  }
+}
+
+
+int main(int argc, char **argv) {
+  mu_Context *ctx = malloc(sizeof(mu_Context));
+
+  if (argc > 1) {
+    Scene s = { .name = "custom", .windows = 1, .frames = 1000 };
+    for (int i = 1; i < argc; i++) {
+      const char *arg = argv[i];
+      const char *val = (i + 1 < argc) ? argv[i + 1] : "0";
+      if      (!strcmp(arg, "--name"))     { s.name = val; i++; }
+      else if (!strcmp(arg, "--windows"))  { s.windows = atoi(val); i++; }
+      else if (!strcmp(arg, "--widgets"))  { s.widgets = atoi(val); i++; }
+      else if (!strcmp(arg, "--depth"))    { s.depth = atoi(val); i++; }
+      else if (!strcmp(arg, "--text-len")) { s.text_len = atoi(val); i++; }
+      else if (!strcmp(arg, "--labels"))   { s.labels = atoi(val); i++; }
+      else if (!strcmp(arg, "--frames"))   { s.frames = mu_max(1, atoi(val)); i++; }
+      else if (!strcmp(arg, "--render"))   { s.render = 1; }
+      else if (!strcmp(arg, "--cache"))    { s.cache = 1; }
+      else if (!strcmp(arg, "--wrap-cache")) { s.wrap_cache = 1; }
+      else if (!strcmp(arg, "--editor"))   { s.editor = atoi(val); i++; }
+      else if (!strcmp(arg, "--log"))      { s.log = atoi(val); i++; }
+      else if (!strcmp(arg, "--log-filter")) { s.log_filter = val; i++; }
+      else if (!strcmp(arg, "--clipper"))  { s.clipper = 1; }
+      else if (!strcmp(arg, "--retained")) { s.retained = 1; }
+      else if (!strcmp(arg, "--table"))    { s.table = atoi(val); i++; }
+      else if (!strcmp(arg, "--threads"))  { s.threads = atoi(val); i++; }
+      else if (!strcmp(arg, "--render-threads")) {
+        s.render_threads = atoi(val);
+        i++;
+      }
+      else if (!strcmp(arg, "--record"))   { s.record = val; i++; }
+      else if (!strcmp(arg, "--replay"))   { s.replay = val; i++; }
+      else if (!strcmp(arg, "--stream"))   { s.stream = 1; }
+      else if (!strcmp(arg, "--kernels"))  {
+        if (!sw_kernels_use(val)) {
+          fprintf(stderr, "kernels '%s' are not supported\n", val);
+          return EXIT_FAILURE;
+        }
+        i++;
+      }
+      else {
+        fprintf(stderr, "unknown argument '%s'\n", arg);
+        return EXIT_FAILURE;
+      }
+    }
+    run_scene(ctx, &s);
+
+  } else {
+    for (Scene *s = suite; s->name; s++) { run_scene(ctx, s); }
+  }
+
+  free(ctx);
+  return 0;
+}
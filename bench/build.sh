@@ -0,0 +1,6 @@
+#!/bin/bash
+
+CFLAGS="-I../src -I../headless -Wall -std=c11 -pedantic -O3 -g -pthread"
+
+gcc bench.c ../headless/swrender.c ../headless/swkernels.c ../headless/swtiles.c ../headless/inputlog.c ../headless/cmdstream.c ../src/microui.c $CFLAGS -o bench
+gcc kernels.c ../headless/swkernels.c $CFLAGS -o kernels
@@ -0,0 +1,96 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "swkernels.h"
+
+/*
+** Times each span kernel of every kernel set the CPU supports over a full HD
+** RGBA8 frame and prints one JSON object per kernel on stdout. Each result is
+** also compared against the scalar kernels. Optionally takes the number of
+** frames to run:
+**
+**   ./kernels 200
+*/
+
+#define WIDTH  1920
+#define HEIGHT 1080
+
+enum { FILL, BLEND, BLEND_MASK, OP_MAX };
+
+static const char *op_names[] = { "fill", "blend", "blend_mask" };
+
+
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static void run(const sw_Kernels *k, int op, uint32_t *px,
+  const unsigned char *mask, int frame)
+{
+  /* vary the color so consecutive frames can't be skipped */
+  mu_Color color = { 40 + frame % 200, 120, 200, op == FILL ? 255 : 160 };
+  int pitch = WIDTH * 4;
+  switch (op) {
+    case FILL:  k->fill(px, pitch, WIDTH, HEIGHT, color); break;
+    case BLEND: k->blend(px, pitch, WIDTH, HEIGHT, color); break;
+    case BLEND_MASK:
+      k->blend_mask(px, pitch, mask, WIDTH, WIDTH, HEIGHT, color);
+      break;
+  }
+}
+
+
+static void init_pixels(uint32_t *px) {
+  for (int i = 0; i < WIDTH * HEIGHT; i++) { px[i] = i * 2654435761u; }
+}
+
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 100;
+  uint32_t *px = malloc(WIDTH * HEIGHT * sizeof(*px));
+  uint32_t *ref = malloc(WIDTH * HEIGHT * sizeof(*px));
+  unsigned char *mask = malloc(WIDTH * HEIGHT);
+  const sw_Kernels *scalar = sw_kernels_find("scalar");
+  const sw_Kernels *k;
+
+  /* glyph-like coverage: runs of empty, partial and full pixels */
+  srand(1);
+  for (int i = 0; i < WIDTH * HEIGHT; i++) {
+    int r = rand() % 8;
+    mask[i] = r < 4 ? 0 : r < 6 ? 255 : rand() % 256;
+  }
+
+  for (int i = 0; (k = sw_kernels_list(i)); i++) {
+    for (int op = 0; op < OP_MAX; op++) {
+      /* check a few frames against the scalar kernels */
+      init_pixels(px);
+      init_pixels(ref);
+      for (int f = 0; f < 3; f++) {
+        run(k, op, px, mask, f);
+        run(scalar, op, ref, mask, f);
+      }
+      int exact = !memcmp(px, ref, WIDTH * HEIGHT * sizeof(*px));
+
+      double t = now_ns();
+      for (int f = 0; f < frames; f++) { run(k, op, px, mask, f); }
+      t = (now_ns() - t) / mu_max(frames, 1);
+
+      printf("{\"kernels\":\"%s\",\"op\":\"%s\",\"width\":%d,\"height\":%d,"
+        "\"frames\":%d,\"ns_per_frame\":%.0f,\"mpix_per_s\":%.0f,"
+        "\"exact\":%s}\n",
+        k->name, op_names[op], WIDTH, HEIGHT, frames, t,
+        WIDTH * HEIGHT / t * 1e3, exact ? "true" : "false");
+      fflush(stdout);
+    }
+  }
+
+  free(px);
+  free(ref);
+  free(mask);
+  return 0;
+}
@@ -10,7 +10,7 @@ else
     GLFLAG="-lGL"
 fi
 
-CFLAGS="-I../src -Wall -std=c11 -pedantic `sdl2-config --libs` $GLFLAG -lm -O3 -g"
+CFLAGS="-I../src -I../headless -Wall -std=c11 -pedantic `sdl2-config --libs` $GLFLAG -lm -O3 -g"
 
-gcc main.c renderer.c ../src/microui.c $CFLAGS
+gcc main.c renderer.c ../headless/inputlog.c ../src/microui.c $CFLAGS
 
@@ -2,17 +2,18 @@
 #include <stdio.h>
 #include "renderer.h"
 #include "microui.h"
+#include "inputlog.h"
 
 
-static  char logbuf[64000];
-static   int logbuf_updated = 0;
+static  char log_text[64000];
+static mu_LogLine log_lines[4096];
+static   int log_matches[4096];
+static mu_Log logbuf;
 static float bg[3] = { 90, 95, 100 };
 
 
 static void write_log(const char *text) {
-  if (logbuf[0]) { strcat(logbuf, "\n"); }
-  strcat(logbuf, text);
-  logbuf_updated = 1;
+  mu_log_append(&logbuf, text, -1);
 }
 
 
@@ -117,18 +118,18 @@ static void test_window(mu_Context *ctx) {
 
 static void log_window(mu_Context *ctx) {
   if (mu_begin_window(ctx, "Log Window", mu_rect(350, 40, 300, 200))) {
-    /* output text panel */
-    mu_layout_row(ctx, 1, (int[]) { -1 }, -25);
-    mu_begin_panel(ctx, "Log Output");
-    mu_Container *panel = mu_get_current_container(ctx);
-    mu_layout_row(ctx, 1, (int[]) { -1 }, -1);
-    mu_text(ctx, logbuf);
-    mu_end_panel(ctx);
-    if (logbuf_updated) {
-      panel->scroll.y = panel->content_size.y;
-      logbuf_updated = 0;
+    /* filter textbox */
+    static char filter[64];
+    mu_layout_row(ctx, 2, (int[]) { 46, -1 }, 0);
+    mu_label(ctx, "Filter:");
+    if (mu_textbox(ctx, filter, sizeof(filter)) & MU_RES_CHANGE) {
+      mu_log_filter(&logbuf, filter);
     }
 
+    /* output lines, scrolled to the newest unless scrolled up */
+    mu_layout_row(ctx, 1, (int[]) { -1 }, -25);
+    mu_log_view(ctx, &logbuf);
+
     /* input textbox + submit button */
     static char buf[128];
     int submitted = 0;
@@ -194,12 +195,59 @@ static void style_window(mu_Context *ctx) {
 }
 
 
-static void process_frame(mu_Context *ctx) {
+static void table_cell(mu_Context *ctx, void *udata, int row, int col, mu_Rect r) {
+  char buf[32];
+  sprintf(buf, "%d, %d", row, col);
+  mu_draw_control_text(ctx, buf, r, MU_COLOR_TEXT, 0);
+}
+
+
+static void table_window(mu_Context *ctx) {
+  static mu_Column columns[32];
+  static char labels[32][16];
+  if (!columns[0].label) {
+    for (int i = 0; i < 32; i++) {
+      sprintf(labels[i], "Column %d", i);
+      columns[i] = (mu_Column) { labels[i], 80 };
+    }
+  }
+
+  if (mu_begin_window(ctx, "Table Window", mu_rect(350, 495, 430, 100))) {
+    mu_layout_row(ctx, 1, (int[]) { -1 }, -1);
+    mu_table(ctx, "Table", columns, 32, 1000000, table_cell, NULL);
+    mu_end_window(ctx);
+  }
+}
+
+
+static void editor_window(mu_Context *ctx) {
+  static mu_TextEdit editor;
+  if (!editor.text) {
+    mu_textedit_set(ctx, &editor,
+      "This text editor keeps its text in a gap buffer,\n"
+      "so typing stays fast in large documents.\n", -1);
+  }
+
+  if (mu_begin_window(ctx, "Editor Window", mu_rect(40, 495, 300, 100))) {
+    mu_layout_row(ctx, 1, (int[]) { -1 }, -1);
+    mu_textedit(ctx, &editor);
+    mu_end_window(ctx);
+  }
+}
+
+
+static int process_frame(mu_Context *ctx, il_Log *input_log) {
   mu_begin(ctx);
+  if (input_log->fp) { il_record_frame(input_log, ctx); }
   style_window(ctx);
   log_window(ctx);
   test_window(ctx);
-  mu_end(ctx);
+  table_window(ctx);
+  editor_window(ctx);
+#ifdef MU_STATS
+  mu_stats_window(ctx, "Stats", mu_rect(480, 40, 300, 450));
+#endif
+  return mu_end(ctx);
 }
 
 
@@ -210,7 +258,7 @@ static const char button_map[256] = {
   [ SDL_BUTTON_MIDDLE & 0xff ] =  MU_MOUSE_MIDDLE,
 };
 
-static const char key_map[256] = {
+static const int key_map[256] = {
   [ SDLK_LSHIFT       & 0xff ] = MU_KEY_SHIFT,
   [ SDLK_RSHIFT       & 0xff ] = MU_KEY_SHIFT,
   [ SDLK_LCTRL        & 0xff ] = MU_KEY_CTRL,
@@ -219,6 +267,15 @@ static const char key_map[256] = {
   [ SDLK_RALT         & 0xff ] = MU_KEY_ALT,
   [ SDLK_RETURN       & 0xff ] = MU_KEY_RETURN,
   [ SDLK_BACKSPACE    & 0xff ] = MU_KEY_BACKSPACE,
+  [ SDLK_DELETE       & 0xff ] = MU_KEY_DELETE,
+  [ SDLK_LEFT         & 0xff ] = MU_KEY_LEFT,
+  [ SDLK_RIGHT        & 0xff ] = MU_KEY_RIGHT,
+  [ SDLK_UP           & 0xff ] = MU_KEY_UP,
+  [ SDLK_DOWN         & 0xff ] = MU_KEY_DOWN,
+  [ SDLK_HOME         & 0xff ] = MU_KEY_HOME,
+  [ SDLK_END          & 0xff ] = MU_KEY_END,
+  [ SDLK_PAGEUP       & 0xff ] = MU_KEY_PAGEUP,
+  [ SDLK_PAGEDOWN     & 0xff ] = MU_KEY_PAGEDOWN,
 };
 
 
@@ -231,6 +288,11 @@ static int text_height(mu_Font font) {
   return r_get_text_height();
 }
 
+static void* alloc(mu_Context *ctx, void *ptr, int size) {
+  if (size == 0) { free(ptr); return NULL; }
+  return realloc(ptr, size);
+}
+
 
 int main(int argc, char **argv) {
   /* init SDL and renderer */
@@ -242,14 +304,40 @@ int main(int argc, char **argv) {
   mu_init(ctx);
   ctx->text_width = text_width;
   ctx->text_height = text_height;
+  ctx->alloc = alloc;
+
+  /* init log, which keeps the newest lines that fit its buffers */
+  mu_log_init(&logbuf, log_text, sizeof(log_text), log_lines, log_matches, 4096);
+
+  /* init draw list */
+  mu_DrawList dl = { 0 };
+  r_init_draw_list(&dl);
+
+  /* `--record <file>` saves the session's input for replaying headlessly */
+  il_Log input_log = { NULL };
+  if (argc > 2 && !strcmp(argv[1], "--record")) {
+    if (!il_record_open(&input_log, argv[2])) {
+      fprintf(stderr, "could not open '%s'\n", argv[2]);
+      exit(EXIT_FAILURE);
+    }
+  }
 
   /* main loop */
+  int redraw = 1;
   for (;;) {
+    /* sleep until there is input, unless the last frame asked for another */
+    if (ctx->frame_delay < 0) {
+      SDL_WaitEvent(NULL);
+    } else if (ctx->frame_delay > 0) {
+      SDL_WaitEventTimeout(NULL, ctx->frame_delay);
+    }
+
     /* handle SDL events */
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
       switch (e.type) {
-        case SDL_QUIT: exit(EXIT_SUCCESS); break;
+        case SDL_QUIT: il_close(&input_log); exit(EXIT_SUCCESS); break;
+        case SDL_WINDOWEVENT: redraw = 1; break;
         case SDL_MOUSEMOTION: mu_input_mousemove(ctx, e.motion.x, e.motion.y); break;
         case SDL_MOUSEWHEEL: mu_input_scroll(ctx, 0, e.wheel.y * -30); break;
         case SDL_TEXTINPUT: mu_input_text(ctx, e.text.text); break;
@@ -273,20 +361,16 @@ int main(int argc, char **argv) {
     }
 
     /* process frame */
-    process_frame(ctx);
+    if (process_frame(ctx, &input_log) & MU_FRAME_CHANGED) { redraw = 1; }
 
     /* render */
-    r_clear(mu_color(bg[0], bg[1], bg[2], 255));
-    mu_Command *cmd = NULL;
-    while (mu_next_command(ctx, &cmd)) {
-      switch (cmd->type) {
-        case MU_COMMAND_TEXT: r_draw_text(cmd->text.str, cmd->text.pos, cmd->text.color); break;
-        case MU_COMMAND_RECT: r_draw_rect(cmd->rect.rect, cmd->rect.color); break;
-        case MU_COMMAND_ICON: r_draw_icon(cmd->icon.id, cmd->icon.rect, cmd->icon.color); break;
-        case MU_COMMAND_CLIP: r_set_clip_rect(cmd->clip.rect); break;
-      }
+    if (redraw) {
+      r_clear(mu_color(bg[0], bg[1], bg[2], 255));
+      mu_drawlist_build(ctx, &dl);
+      r_draw_list(&dl);
+      r_present();
+      redraw = 0;
     }
-    r_present();
   }
 
   return 0;
@@ -4,12 +4,10 @@
 #include "microui.h"
 
 void r_init(void);
-void r_draw_rect(mu_Rect rect, mu_Color color);
-void r_draw_text(const char *text, mu_Vec2 pos, mu_Color color);
-void r_draw_icon(int id, mu_Rect rect, mu_Color color);
+void r_init_draw_list(mu_DrawList *dl);
+void r_draw_list(const mu_DrawList *dl);
  int r_get_text_width(const char *text, int len);
  int r_get_text_height(void);
-void r_set_clip_rect(mu_Rect rect);
 void r_clear(mu_Color color);
 void r_present(void);
 
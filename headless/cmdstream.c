@@ -0,0 +1,459 @@
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cmdstream.h"
+
+#define HASH_INITIAL 2166136261
+#define MAX_VARINT 5
+#define READ_CHUNK 65536
+
+
+static void* grow(void *ptr, int *cap, int need, int elem) {
+  int n = *cap ? *cap : 64;
+  if (need <= *cap) { return ptr; }
+  while (n < need) { n = n > INT_MAX / 2 ? need : n * 2; }
+  ptr = realloc(ptr, (size_t) n * elem);
+  if (!ptr) { abort(); }
+  *cap = n;
+  return ptr;
+}
+
+
+static unsigned hash_bytes(const unsigned char *p, int size) {
+  unsigned h = HASH_INITIAL;
+  while (size--) { h = (h ^ *p++) * 16777619; }
+  return h;
+}
+
+
+/*============================================================================
+** writing
+**============================================================================*/
+
+static void put(cs_Buffer *b, const void *data, int size) {
+  b->data = grow(b->data, &b->cap, b->size + size, 1);
+  memcpy(b->data + b->size, data, size);
+  b->size += size;
+}
+
+
+static void put_byte(cs_Buffer *b, int c) {
+  unsigned char x = c;
+  put(b, &x, 1);
+}
+
+
+static int varint(unsigned char *dst, unsigned v) {
+  int n = 0;
+  while (v >= 0x80) { dst[n++] = (v & 0x7f) | 0x80; v >>= 7; }
+  dst[n++] = v;
+  return n;
+}
+
+
+static void put_varint(cs_Buffer *b, unsigned v) {
+  unsigned char buf[MAX_VARINT];
+  put(b, buf, varint(buf, v));
+}
+
+
+static void put_svarint(cs_Buffer *b, int v) {
+  put_varint(b, ((unsigned) v << 1) ^ (unsigned) -(v < 0));
+}
+
+
+static void put_rect(cs_Buffer *b, mu_Rect r) {
+  put_svarint(b, r.x); put_svarint(b, r.y);
+  put_svarint(b, r.w); put_svarint(b, r.h);
+}
+
+
+static void put_color(cs_Buffer *b, mu_Color c) {
+  unsigned char buf[4];
+  buf[0] = c.r; buf[1] = c.g; buf[2] = c.b; buf[3] = c.a;
+  put(b, buf, 4);
+}
+
+
+static void put_command(cs_Encoder *e, cs_Buffer *b, mu_Command *cmd) {
+  switch (cmd->type) {
+    case MU_COMMAND_CLIP:
+      put_byte(b, CS_CLIP);
+      put_rect(b, cmd->clip.rect);
+      break;
+    case MU_COMMAND_RECT:
+      put_byte(b, CS_RECT);
+      put_rect(b, cmd->rect.rect);
+      put_color(b, cmd->rect.color);
+      break;
+    case MU_COMMAND_ICON:
+      put_byte(b, CS_ICON);
+      put_varint(b, cmd->icon.id);
+      put_rect(b, cmd->icon.rect);
+      put_color(b, cmd->icon.color);
+      break;
+    case MU_COMMAND_TEXT: {
+      int len = strlen(cmd->text.str);
+      put_byte(b, CS_TEXT);
+      put_varint(b, e->font_id ? e->font_id(cmd->text.font) : 0);
+      put_svarint(b, cmd->text.pos.x);
+      put_svarint(b, cmd->text.pos.y);
+      put_color(b, cmd->text.color);
+      put_varint(b, len);
+      put(b, cmd->text.str, len);
+      break;
+    }
+  }
+}
+
+
+static void frame_reset(cs_Frame *f) {
+  f->bytes.size = 0;
+  f->count = 0;
+}
+
+
+static void frame_push(cs_Frame *f, int start) {
+  if (f->count + 2 > f->cap) {
+    f->offsets = grow(f->offsets, &f->cap, f->count + 2, sizeof(int));
+    f->hashes = realloc(f->hashes, (size_t) f->cap * sizeof(unsigned));
+    if (!f->hashes) { abort(); }
+  }
+  f->offsets[f->count] = start;
+  f->offsets[f->count + 1] = f->bytes.size;
+  f->hashes[f->count] = hash_bytes(f->bytes.data + start, f->bytes.size - start);
+  f->count++;
+}
+
+
+static void frame_free(cs_Frame *f) {
+  free(f->bytes.data);
+  free(f->offsets);
+  free(f->hashes);
+}
+
+
+static int same_command(cs_Frame *a, int i, cs_Frame *b, int j) {
+  int size = a->offsets[i + 1] - a->offsets[i];
+  return a->hashes[i] == b->hashes[j]
+    && size == b->offsets[j + 1] - b->offsets[j]
+    && memcmp(a->bytes.data + a->offsets[i], b->bytes.data + b->offsets[j], size) == 0;
+}
+
+
+static void build_table(cs_Encoder *e) {
+  int i, n = 64;
+  while (n < e->prev.count * 2) { n *= 2; }
+  if (n > e->table_size) {
+    e->table = realloc(e->table, n * sizeof(int));
+    if (!e->table) { abort(); }
+    e->table_size = n;
+  }
+  memset(e->table, 0, e->table_size * sizeof(int));
+  /* insert back to front so a lookup finds the first of equal commands */
+  for (i = e->prev.count - 1; i >= 0; i--) {
+    int slot = e->prev.hashes[i] & (e->table_size - 1);
+    while (e->table[slot]) { slot = (slot + 1) & (e->table_size - 1); }
+    e->table[slot] = i + 1;
+  }
+}
+
+
+static int find_match(cs_Encoder *e, int i, int next) {
+  int slot;
+  /* prefer continuing the previous copy; it is the common case */
+  if (next < e->prev.count && same_command(&e->cur, i, &e->prev, next)) {
+    return next;
+  }
+  slot = e->cur.hashes[i] & (e->table_size - 1);
+  while (e->table[slot]) {
+    int j = e->table[slot] - 1;
+    if (same_command(&e->cur, i, &e->prev, j)) { return j; }
+    slot = (slot + 1) & (e->table_size - 1);
+  }
+  return -1;
+}
+
+
+static void put_literals(cs_Encoder *e, int from, int to) {
+  cs_Frame *f = &e->cur;
+  if (to == from) { return; }
+  put_varint(&e->out, (unsigned) (to - from) << 1);
+  put(&e->out, f->bytes.data + f->offsets[from], f->offsets[to] - f->offsets[from]);
+}
+
+
+int cs_encode(cs_Encoder *e, mu_Context *ctx) {
+  unsigned char len[MAX_VARINT] = { 0 };
+  mu_Command *cmd = NULL;
+  cs_Frame tmp;
+  int i, n, lit = 0, next = 0, key;
+
+  /* encode the finished command list */
+  frame_reset(&e->cur);
+  while (mu_next_command(ctx, &cmd)) {
+    int start = e->cur.bytes.size;
+    put_command(e, &e->cur.bytes, cmd);
+    frame_push(&e->cur, start);
+  }
+
+  /* emit ops, leaving room in front of them for the length */
+  key = e->frames == 0
+    || (e->keyframe_interval > 0 && e->frames % e->keyframe_interval == 0);
+  if (!key) { build_table(e); }
+  e->out.size = 0;
+  if (e->frames == 0) {
+    put(&e->out, "muCS", 4);
+    put_byte(&e->out, CS_VERSION);
+  }
+  put(&e->out, len, MAX_VARINT);
+  n = e->cur.count;
+  for (i = 0; i < n;) {
+    int j = key ? -1 : find_match(e, i, next);
+    int count = 1;
+    if (j < 0) { i++; continue; }
+    while (i + count < n && j + count < e->prev.count
+      && same_command(&e->cur, i + count, &e->prev, j + count)) { count++; }
+    put_literals(e, lit, i);
+    put_varint(&e->out, (unsigned) count << 1 | 1);
+    put_varint(&e->out, j);
+    i += count;
+    lit = i;
+    next = j + count;
+  }
+  put_literals(e, lit, n);
+
+  /* move the header up against the length so the frame is contiguous */
+  {
+    int head = e->frames == 0 ? 5 : 0;
+    int ops = e->out.size - head - MAX_VARINT;
+    int k = varint(len, ops);
+    int start = MAX_VARINT - k;
+    memmove(e->out.data + start, e->out.data, head);
+    memcpy(e->out.data + start + head, len, k);
+    e->last_size = e->out.size - start;
+    if (!e->write(e->udata, e->out.data + start, e->last_size)) { return 0; }
+  }
+
+  tmp = e->prev; e->prev = e->cur; e->cur = tmp;
+  e->frames++;
+  return 1;
+}
+
+
+void cs_encoder_free(cs_Encoder *e) {
+  frame_free(&e->prev);
+  frame_free(&e->cur);
+  free(e->table);
+  free(e->out.data);
+}
+
+
+/*============================================================================
+** reading
+**============================================================================*/
+
+typedef struct {
+  const unsigned char *p, *end;
+  int error;
+} Reader;
+
+
+static int get_byte(Reader *r) {
+  if (r->p == r->end) { r->error = 1; return 0; }
+  return *r->p++;
+}
+
+
+static unsigned get_varint(Reader *r) {
+  unsigned v = 0;
+  int shift, c;
+  for (shift = 0; shift < 32; shift += 7) {
+    c = get_byte(r);
+    v |= (unsigned) (c & 0x7f) << shift;
+    if (!(c & 0x80)) { return v; }
+  }
+  r->error = 1;
+  return 0;
+}
+
+
+static int get_svarint(Reader *r) {
+  unsigned v = get_varint(r);
+  return (int) (v >> 1) ^ -(int) (v & 1);
+}
+
+
+static mu_Rect get_rect(Reader *r) {
+  mu_Rect rect;
+  rect.x = get_svarint(r); rect.y = get_svarint(r);
+  rect.w = get_svarint(r); rect.h = get_svarint(r);
+  return rect;
+}
+
+
+static mu_Color get_color(Reader *r) {
+  mu_Color c;
+  c.r = get_byte(r); c.g = get_byte(r); c.b = get_byte(r); c.a = get_byte(r);
+  return c;
+}
+
+
+static mu_Command* push_record(cs_Decoder *d, int type, int size) {
+  mu_Command *cmd;
+  size = (size + sizeof(void*) - 1) & ~(int) (sizeof(void*) - 1);
+  d->records.data = grow(d->records.data, &d->records.cap, d->records.size + size, 1);
+  cmd = (mu_Command*) (d->records.data + d->records.size);
+  cmd->base.type = type;
+  cmd->base.size = size;
+  d->records.size += size;
+  return cmd;
+}
+
+
+/* parses one command; when `d` is non-null also appends its record */
+static void get_command(cs_Decoder *d, Reader *r) {
+  mu_Command *cmd;
+  switch (get_byte(r)) {
+    case CS_CLIP: {
+      mu_Rect rect = get_rect(r);
+      if (!d) { break; }
+      cmd = push_record(d, MU_COMMAND_CLIP, sizeof(mu_ClipCommand));
+      cmd->clip.rect = rect;
+      break;
+    }
+    case CS_RECT: {
+      mu_Rect rect = get_rect(r);
+      mu_Color color = get_color(r);
+      if (!d) { break; }
+      cmd = push_record(d, MU_COMMAND_RECT, sizeof(mu_RectCommand));
+      cmd->rect.rect = rect;
+      cmd->rect.color = color;
+      break;
+    }
+    case CS_ICON: {
+      int id = get_varint(r);
+      mu_Rect rect = get_rect(r);
+      mu_Color color = get_color(r);
+      if (!d) { break; }
+      cmd = push_record(d, MU_COMMAND_ICON, sizeof(mu_IconCommand));
+      cmd->icon.id = id;
+      cmd->icon.rect = rect;
+      cmd->icon.color = color;
+      break;
+    }
+    case CS_TEXT: {
+      int font = get_varint(r);
+      int x = get_svarint(r);
+      int y = get_svarint(r);
+      mu_Color color = get_color(r);
+      unsigned len = get_varint(r);
+      const unsigned char *str = r->p;
+      if (len > (unsigned) (r->end - r->p)) { r->error = 1; break; }
+      r->p += len;
+      if (!d) { break; }
+      cmd = push_record(d, MU_COMMAND_TEXT, sizeof(mu_TextCommand) + len);
+      cmd->text.font = d->font ? d->font(font) : NULL;
+      cmd->text.pos = mu_vec2(x, y);
+      cmd->text.color = color;
+      memcpy(cmd->text.str, str, len);
+      cmd->text.str[len] = '\0';
+      break;
+    }
+    default:
+      r->error = 1;
+      break;
+  }
+}
+
+
+static int apply_ops(cs_Decoder *d, Reader *r) {
+  cs_Frame *cur = &d->cur, *prev = &d->prev;
+  frame_reset(cur);
+  while (r->p < r->end && !r->error) {
+    unsigned op = get_varint(r);
+    unsigned count = op >> 1;
+    if (op & 1) {
+      unsigned i, start = get_varint(r);
+      if (start > (unsigned) prev->count || count > prev->count - start) { return 0; }
+      for (i = start; i < start + count; i++) {
+        int pos = cur->bytes.size;
+        put(&cur->bytes, prev->bytes.data + prev->offsets[i],
+          prev->offsets[i + 1] - prev->offsets[i]);
+        frame_push(cur, pos);
+      }
+    } else {
+      while (count-- && !r->error) {
+        const unsigned char *p = r->p;
+        int pos = cur->bytes.size;
+        get_command(NULL, r);
+        if (r->error) { return 0; }
+        put(&cur->bytes, p, r->p - p);
+        frame_push(cur, pos);
+      }
+    }
+  }
+  return !r->error;
+}
+
+
+int cs_decode(cs_Decoder *d) {
+  unsigned char c;
+  unsigned size = 0;
+  int shift = 0;
+  cs_Frame tmp;
+  Reader r;
+
+  if (!d->started) {
+    unsigned char head[5];
+    if (!d->read(d->udata, head, 5)) { return 0; }
+    if (memcmp(head, "muCS", 4) || head[4] != CS_VERSION) { return 0; }
+    d->started = 1;
+  }
+
+  /* read the frame */
+  do {
+    if (shift > 28 || !d->read(d->udata, &c, 1)) { return 0; }
+    size |= (unsigned) (c & 0x7f) << shift;
+    shift += 7;
+  } while (c & 0x80);
+  if (size > INT_MAX) { return 0; }
+  /* read in chunks so a corrupt length fails at the end of the stream rather
+  ** than allocating up front */
+  d->in.size = 0;
+  while (d->in.size < (int) size) {
+    int n = mu_min((int) size - d->in.size, READ_CHUNK);
+    d->in.data = grow(d->in.data, &d->in.cap, d->in.size + n, 1);
+    if (!d->read(d->udata, d->in.data + d->in.size, n)) { return 0; }
+    d->in.size += n;
+  }
+
+  /* rebuild the encoded frame, then decode it into command records */
+  r.p = d->in.data; r.end = r.p + size; r.error = 0;
+  if (!apply_ops(d, &r)) { return 0; }
+  d->records.size = 0;
+  r.p = d->cur.bytes.data; r.end = r.p + d->cur.bytes.size;
+  while (r.p < r.end) { get_command(d, &r); }
+
+  tmp = d->prev; d->prev = d->cur; d->cur = tmp;
+  return 1;
+}
+
+
+int cs_next_command(cs_Decoder *d, mu_Command **cmd) {
+  unsigned char *end = d->records.data + d->records.size;
+  if (*cmd) {
+    *cmd = (mu_Command*) (((char*) *cmd) + (*cmd)->base.size);
+  } else {
+    *cmd = (mu_Command*) d->records.data;
+  }
+  return (unsigned char*) *cmd != end;
+}
+
+
+void cs_decoder_free(cs_Decoder *d) {
+  frame_free(&d->prev);
+  frame_free(&d->cur);
+  free(d->in.data);
+  free(d->records.data);
+}
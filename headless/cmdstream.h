@@ -0,0 +1,75 @@
+#ifndef CMDSTREAM_H
+#define CMDSTREAM_H
+
+#include "microui.h"
+
+/*
+** Serializes finished command lists so a UI built in one process can be drawn
+** by another, eg. over a pipe or local socket. All values are byte-sized or
+** LEB128 varints, so the format does not depend on endianness:
+**
+**   stream  := "muCS" version:u8 frame*
+**   frame   := length:varint op* (length is the size of the ops in bytes)
+**   op      := (count << 1 | 0):varint command{count}   literal commands
+**            | (count << 1 | 1):varint start:varint     copy `count` commands
+**                                                        of the last frame
+**   command := CS_RECT rect color | CS_CLIP rect
+**            | CS_ICON id:varint rect color
+**            | CS_TEXT font:varint x:svarint y:svarint color len:varint str
+**   rect    := x:svarint y:svarint w:svarint h:svarint
+**   color   := r:u8 g:u8 b:u8 a:u8
+**
+** Commands are written in drawing order with jumps resolved. Signed values are
+** zigzag encoded. A key frame consists only of literal commands; other frames
+** copy runs of unchanged commands from the frame before them.
+*/
+
+#define CS_VERSION 1
+
+enum { CS_CLIP = 1, CS_RECT, CS_TEXT, CS_ICON };
+
+typedef struct {
+  unsigned char *data;
+  int size, cap;
+} cs_Buffer;
+
+typedef struct {
+  cs_Buffer bytes;  /* encoded commands */
+  int *offsets;     /* start of each command in `bytes`, plus the end */
+  unsigned *hashes;
+  int count, cap;
+} cs_Frame;
+
+typedef struct {
+  /* set by the user */
+  int (*write)(void *udata, const void *data, int size); /* 0 on failure */
+  int (*font_id)(mu_Font font);
+  void *udata;
+  int keyframe_interval; /* send a key frame every n frames, 0 for only the first */
+  /* state */
+  int frames;
+  int last_size; /* bytes written for the last frame */
+  cs_Frame prev, cur;
+  int *table, table_size;
+  cs_Buffer out;
+} cs_Encoder;
+
+typedef struct {
+  /* set by the user */
+  int (*read)(void *udata, void *data, int size); /* reads exactly `size`; 0 on failure */
+  mu_Font (*font)(int id);
+  void *udata;
+  /* state */
+  int started;
+  cs_Frame prev, cur;
+  cs_Buffer in;
+  cs_Buffer records; /* decoded commands of the current frame */
+} cs_Decoder;
+
+int cs_encode(cs_Encoder *e, mu_Context *ctx);
+void cs_encoder_free(cs_Encoder *e);
+int cs_decode(cs_Decoder *d);
+int cs_next_command(cs_Decoder *d, mu_Command **cmd);
+void cs_decoder_free(cs_Decoder *d);
+
+#endif
@@ -0,0 +1,150 @@
+#include <string.h>
+#include "inputlog.h"
+
+
+static void put_varint(FILE *fp, unsigned v) {
+  while (v >= 0x80) { putc((v & 0x7f) | 0x80, fp); v >>= 7; }
+  putc(v, fp);
+}
+
+
+static void put_svarint(FILE *fp, int v) {
+  put_varint(fp, ((unsigned) v << 1) ^ (unsigned) -(v < 0));
+}
+
+
+static int get_varint(FILE *fp, unsigned *v) {
+  int shift, c;
+  *v = 0;
+  for (shift = 0; shift < 32; shift += 7) {
+    if ((c = getc(fp)) == EOF) { return 0; }
+    *v |= (unsigned) (c & 0x7f) << shift;
+    if (!(c & 0x80)) { return 1; }
+  }
+  return 0;
+}
+
+
+static int get_svarint(FILE *fp, int *v) {
+  unsigned u;
+  if (!get_varint(fp, &u)) { return 0; }
+  *v = (int) (u >> 1) ^ -(int) (u & 1);
+  return 1;
+}
+
+
+static void reset(il_Log *log, FILE *fp) {
+  memset(log, 0, sizeof(*log));
+  log->fp = fp;
+}
+
+
+int il_record_open(il_Log *log, const char *filename) {
+  FILE *fp = fopen(filename, "wb");
+  if (!fp) { return 0; }
+  reset(log, fp);
+  fwrite("muIL", 1, 4, fp);
+  putc(IL_VERSION, fp);
+  return 1;
+}
+
+
+int il_record_frame(il_Log *log, mu_Context *ctx) {
+  int len = strlen(ctx->input_text);
+  int flags = 0;
+  if (ctx->mouse_pos.x != log->mouse_pos.x
+    || ctx->mouse_pos.y != log->mouse_pos.y) { flags |= IL_MOUSEPOS;     }
+  if (ctx->mouse_down != log->mouse_down)    { flags |= IL_MOUSEDOWN;    }
+  if (ctx->mouse_pressed)                    { flags |= IL_MOUSEPRESSED; }
+  if (ctx->key_down != log->key_down)        { flags |= IL_KEYDOWN;      }
+  if (ctx->key_pressed)                      { flags |= IL_KEYPRESSED;   }
+  if (ctx->scroll_delta.x || ctx->scroll_delta.y) { flags |= IL_SCROLL;  }
+  if (len)                                   { flags |= IL_TEXT;         }
+
+  putc(flags, log->fp);
+  if (flags & IL_MOUSEPOS) {
+    put_svarint(log->fp, ctx->mouse_pos.x - log->mouse_pos.x);
+    put_svarint(log->fp, ctx->mouse_pos.y - log->mouse_pos.y);
+  }
+  if (flags & IL_MOUSEDOWN)    { put_varint(log->fp, ctx->mouse_down);    }
+  if (flags & IL_MOUSEPRESSED) { put_varint(log->fp, ctx->mouse_pressed); }
+  if (flags & IL_KEYDOWN)      { put_varint(log->fp, ctx->key_down);      }
+  if (flags & IL_KEYPRESSED)   { put_varint(log->fp, ctx->key_pressed);   }
+  if (flags & IL_SCROLL) {
+    put_svarint(log->fp, ctx->scroll_delta.x);
+    put_svarint(log->fp, ctx->scroll_delta.y);
+  }
+  if (flags & IL_TEXT) {
+    put_varint(log->fp, len);
+    fwrite(ctx->input_text, 1, len, log->fp);
+  }
+
+  log->mouse_pos = ctx->mouse_pos;
+  log->mouse_down = ctx->mouse_down;
+  log->key_down = ctx->key_down;
+  log->frames++;
+  return !ferror(log->fp);
+}
+
+
+int il_play_open(il_Log *log, const char *filename) {
+  unsigned char head[5];
+  FILE *fp = fopen(filename, "rb");
+  if (!fp) { return 0; }
+  if (fread(head, 1, 5, fp) != 5
+    || memcmp(head, "muIL", 4) || head[4] != IL_VERSION) {
+    fclose(fp);
+    return 0;
+  }
+  reset(log, fp);
+  return 1;
+}
+
+
+/* returns 0 at the end of the log or if the log is damaged */
+int il_play_frame(il_Log *log, mu_Context *ctx) {
+  unsigned mouse_pressed = 0, key_pressed = 0, len = 0;
+  unsigned mouse_down = log->mouse_down, key_down = log->key_down;
+  mu_Vec2 pos = log->mouse_pos, delta = mu_vec2(0, 0), scroll = mu_vec2(0, 0);
+  char text[sizeof(ctx->input_text)];
+  int flags = getc(log->fp);
+  if (flags == EOF) { return 0; }
+
+  if ((flags & IL_MOUSEPOS)
+    && !(get_svarint(log->fp, &delta.x) && get_svarint(log->fp, &delta.y))) { return 0; }
+  if ((flags & IL_MOUSEDOWN)    && !get_varint(log->fp, &mouse_down))    { return 0; }
+  if ((flags & IL_MOUSEPRESSED) && !get_varint(log->fp, &mouse_pressed)) { return 0; }
+  if ((flags & IL_KEYDOWN)      && !get_varint(log->fp, &key_down))      { return 0; }
+  if ((flags & IL_KEYPRESSED)   && !get_varint(log->fp, &key_pressed))   { return 0; }
+  if ((flags & IL_SCROLL)
+    && !(get_svarint(log->fp, &scroll.x) && get_svarint(log->fp, &scroll.y))) { return 0; }
+  if (flags & IL_TEXT) {
+    if (!get_varint(log->fp, &len) || len >= sizeof(text)) { return 0; }
+    if (fread(text, 1, len, log->fp) != len) { return 0; }
+  }
+  text[len] = '\0';
+
+  /* the input fields are overwritten rather than fed through mu_input_*() so
+  ** the context sees exactly the state it had when the frame was recorded */
+  pos.x += delta.x;
+  pos.y += delta.y;
+  ctx->mouse_pos = pos;
+  ctx->mouse_down = mouse_down;
+  ctx->mouse_pressed = mouse_pressed;
+  ctx->key_down = key_down;
+  ctx->key_pressed = key_pressed;
+  ctx->scroll_delta = scroll;
+  memcpy(ctx->input_text, text, len + 1);
+
+  log->mouse_pos = pos;
+  log->mouse_down = mouse_down;
+  log->key_down = key_down;
+  log->frames++;
+  return 1;
+}
+
+
+void il_close(il_Log *log) {
+  if (log->fp) { fclose(log->fp); }
+  log->fp = NULL;
+}
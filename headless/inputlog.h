@@ -0,0 +1,48 @@
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <stdio.h>
+#include "microui.h"
+
+/*
+** Records the input a context receives each frame to a file and feeds it back
+** later, so a captured session can be rerun exactly. Call `il_play_frame()`
+** immediately before each `mu_begin()`, or `il_record_frame()` immediately
+** after it, once the frame's queued events have been applied. The file is:
+**
+**   log   := "muIL" version:u8 frame*
+**   frame := flags:u8 [dx:svarint dy:svarint] [mouse_down:varint]
+**            [mouse_pressed:varint] [key_down:varint] [key_pressed:varint]
+**            [scroll_x:svarint scroll_y:svarint] [len:varint text]
+**
+** where each optional field is present only if its IL_* bit is set in
+** `flags`, so an idle frame takes a single byte.
+*/
+
+#define IL_VERSION 1
+
+enum {
+  IL_MOUSEPOS     = (1 << 0),
+  IL_MOUSEDOWN    = (1 << 1),
+  IL_MOUSEPRESSED = (1 << 2),
+  IL_KEYDOWN      = (1 << 3),
+  IL_KEYPRESSED   = (1 << 4),
+  IL_SCROLL       = (1 << 5),
+  IL_TEXT         = (1 << 6)
+};
+
+typedef struct {
+  FILE *fp;
+  int frames;
+  /* input as of the last frame */
+  mu_Vec2 mouse_pos;
+  int mouse_down, key_down;
+} il_Log;
+
+int il_record_open(il_Log *log, const char *filename);
+int il_record_frame(il_Log *log, mu_Context *ctx);
+int il_play_open(il_Log *log, const char *filename);
+int il_play_frame(il_Log *log, mu_Context *ctx);
+void il_close(il_Log *log);
+
+#endif
@@ -0,0 +1,569 @@
+#include <string.h>
+#include "swkernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define SW_X86
+  #include <immintrin.h>
+  #ifdef _MSC_VER
+    #include <intrin.h>
+  #endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #define SW_NEON
+  #include <arm_neon.h>
+#endif
+
+/* lets a function use instructions beyond those the file is compiled for */
+#if defined(__GNUC__)
+  #define TARGET(x) __attribute__((target(x)))
+#else
+  #define TARGET(x)
+#endif
+
+#define next_row(p, pitch) ((void*) ((char*) (p) + (pitch)))
+
+
+/* exact x / 255 for x in [0, 255 * 255] */
+static unsigned div255(unsigned x) {
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+
+static uint32_t pack_color(mu_Color c) {
+  uint32_t res;
+  memcpy(&res, &c, sizeof(res));
+  return res;
+}
+
+
+/*==============================================================================
+** scalar
+**============================================================================*/
+
+static void fill_scalar(uint32_t *dst, int pitch, int w, int h,
+  mu_Color color)
+{
+  uint32_t px = pack_color(color);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    for (int x = 0; x < w; x++) { dst[x] = px; }
+  }
+}
+
+
+static void blend_scalar(uint32_t *dst, int pitch, int w, int h,
+  mu_Color color)
+{
+  /* premultiply source once */
+  unsigned inv = 255 - color.a;
+  unsigned sr = color.r * color.a, sg = color.g * color.a;
+  unsigned sb = color.b * color.a, sa = 255 * color.a;
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    unsigned char *d = (unsigned char*) dst;
+    for (int x = 0; x < w; x++, d += 4) {
+      d[0] = div255(sr + d[0] * inv);
+      d[1] = div255(sg + d[1] * inv);
+      d[2] = div255(sb + d[2] * inv);
+      d[3] = div255(sa + d[3] * inv);
+    }
+  }
+}
+
+
+static void blend_mask_scalar(uint32_t *dst, int pitch,
+  const unsigned char *mask, int mask_pitch, int w, int h, mu_Color color)
+{
+  uint32_t px = pack_color(color);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch), mask += mask_pitch) {
+    unsigned char *d = (unsigned char*) dst;
+    for (int x = 0; x < w; x++, d += 4) {
+      unsigned a = mask[x];
+      if (a == 0) { continue; }
+      if (color.a != 255) { a = div255(a * color.a); }
+      if (a == 255) { memcpy(d, &px, 4); continue; }
+      unsigned inv = 255 - a;
+      d[0] = div255(color.r * a + d[0] * inv);
+      d[1] = div255(color.g * a + d[1] * inv);
+      d[2] = div255(color.b * a + d[2] * inv);
+      d[3] = div255(255 * a + d[3] * inv);
+    }
+  }
+}
+
+
+static const sw_Kernels kernels_scalar = {
+  "scalar", fill_scalar, blend_scalar, blend_mask_scalar
+};
+
+
+/*==============================================================================
+** SSE2, 4 pixels at a time as two vectors of 16bit channels. the last pixels
+** of a row are staged through a buffer so they are handled the same way
+**============================================================================*/
+
+#ifdef SW_X86
+
+TARGET("sse2")
+static inline __m128i div255_sse2(__m128i x) {
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+
+/* blends the 16bit channels of two pixels `d` with per channel alphas `a` */
+TARGET("sse2")
+static inline __m128i blend_px_sse2(__m128i d, __m128i src, __m128i a) {
+  __m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), a);
+  return div255_sse2(_mm_add_epi16(
+    _mm_mullo_epi16(src, a), _mm_mullo_epi16(d, inv)));
+}
+
+
+/* blends 4 pixels with a premultiplied source */
+TARGET("sse2")
+static inline __m128i blend4_sse2(__m128i p, __m128i src, __m128i inv) {
+  __m128i zero = _mm_setzero_si128();
+  __m128i lo = _mm_unpacklo_epi8(p, zero);
+  __m128i hi = _mm_unpackhi_epi8(p, zero);
+  lo = div255_sse2(_mm_add_epi16(src, _mm_mullo_epi16(lo, inv)));
+  hi = div255_sse2(_mm_add_epi16(src, _mm_mullo_epi16(hi, inv)));
+  return _mm_packus_epi16(lo, hi);
+}
+
+
+/* blends 4 pixels through the 4 mask bytes in `m` */
+TARGET("sse2")
+static inline __m128i blend_mask4_sse2(__m128i p, uint32_t m, __m128i src,
+  __m128i ca, int scale)
+{
+  __m128i zero = _mm_setzero_si128();
+  /* spread each mask byte over the 4 channels of its pixel */
+  __m128i a = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int) m), zero);
+  a = _mm_unpacklo_epi16(a, a);
+  __m128i alo = _mm_unpacklo_epi32(a, a);
+  __m128i ahi = _mm_unpackhi_epi32(a, a);
+  if (scale) {
+    alo = div255_sse2(_mm_mullo_epi16(alo, ca));
+    ahi = div255_sse2(_mm_mullo_epi16(ahi, ca));
+  }
+  __m128i lo = blend_px_sse2(_mm_unpacklo_epi8(p, zero), src, alo);
+  __m128i hi = blend_px_sse2(_mm_unpackhi_epi8(p, zero), src, ahi);
+  return _mm_packus_epi16(lo, hi);
+}
+
+
+TARGET("sse2")
+static void fill_sse2(uint32_t *dst, int pitch, int w, int h, mu_Color color) {
+  uint32_t px = pack_color(color);
+  __m128i v = _mm_set1_epi32((int) px);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    int x = 0;
+    for (; x + 4 <= w; x += 4) { _mm_storeu_si128((__m128i*) (dst + x), v); }
+    for (; x < w; x++) { dst[x] = px; }
+  }
+}
+
+
+TARGET("sse2")
+static void blend_sse2(uint32_t *dst, int pitch, int w, int h,
+  mu_Color color)
+{
+  /* premultiplied source; products above 32767 wrap, as 16bit lanes */
+  short sr = (short) (color.r * color.a), sg = (short) (color.g * color.a);
+  short sb = (short) (color.b * color.a), sa = (short) (255 * color.a);
+  __m128i src = _mm_setr_epi16(sr, sg, sb, sa, sr, sg, sb, sa);
+  __m128i inv = _mm_set1_epi16(255 - color.a);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    int x = 0;
+    for (; x + 4 <= w; x += 4) {
+      __m128i *p = (__m128i*) (dst + x);
+      _mm_storeu_si128(p, blend4_sse2(_mm_loadu_si128(p), src, inv));
+    }
+    if (x < w) {
+      uint32_t buf[4];
+      memcpy(buf, dst + x, (w - x) * 4);
+      __m128i *p = (__m128i*) buf;
+      _mm_storeu_si128(p, blend4_sse2(_mm_loadu_si128(p), src, inv));
+      memcpy(dst + x, buf, (w - x) * 4);
+    }
+  }
+}
+
+
+TARGET("sse2")
+static void blend_mask_sse2(uint32_t *dst, int pitch,
+  const unsigned char *mask, int mask_pitch, int w, int h, mu_Color color)
+{
+  __m128i src = _mm_setr_epi16(
+    color.r, color.g, color.b, 255, color.r, color.g, color.b, 255);
+  __m128i ca = _mm_set1_epi16(color.a);
+  int scale = color.a != 255;
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch), mask += mask_pitch) {
+    int x = 0;
+    uint32_t m;
+    for (; x + 4 <= w; x += 4) {
+      memcpy(&m, mask + x, sizeof(m));
+      if (m == 0) { continue; }
+      __m128i *p = (__m128i*) (dst + x);
+      _mm_storeu_si128(p,
+        blend_mask4_sse2(_mm_loadu_si128(p), m, src, ca, scale));
+    }
+    if (x < w) {
+      uint32_t buf[4];
+      m = 0;
+      memcpy(&m, mask + x, w - x);
+      if (m == 0) { continue; }
+      memcpy(buf, dst + x, (w - x) * 4);
+      __m128i *p = (__m128i*) buf;
+      _mm_storeu_si128(p,
+        blend_mask4_sse2(_mm_loadu_si128(p), m, src, ca, scale));
+      memcpy(dst + x, buf, (w - x) * 4);
+    }
+  }
+}
+
+
+static const sw_Kernels kernels_sse2 = {
+  "sse2", fill_sse2, blend_sse2, blend_mask_sse2
+};
+
+
+/*==============================================================================
+** AVX2, 8 pixels at a time; unpacks and packs work within each 128bit lane,
+** so the lanes are handled as two independent SSE2 vectors. the last pixels
+** of a row use masked loads and stores
+**============================================================================*/
+
+TARGET("avx2")
+static inline __m256i div255_avx2(__m256i x) {
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+
+TARGET("avx2")
+static inline __m256i blend_px_avx2(__m256i d, __m256i src, __m256i a) {
+  __m256i inv = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+  return div255_avx2(_mm256_add_epi16(
+    _mm256_mullo_epi16(src, a), _mm256_mullo_epi16(d, inv)));
+}
+
+
+TARGET("avx2")
+static inline __m256i blend8_avx2(__m256i p, __m256i src, __m256i inv) {
+  __m256i zero = _mm256_setzero_si256();
+  __m256i lo = _mm256_unpacklo_epi8(p, zero);
+  __m256i hi = _mm256_unpackhi_epi8(p, zero);
+  lo = div255_avx2(_mm256_add_epi16(src, _mm256_mullo_epi16(lo, inv)));
+  hi = div255_avx2(_mm256_add_epi16(src, _mm256_mullo_epi16(hi, inv)));
+  return _mm256_packus_epi16(lo, hi);
+}
+
+
+/* blends 8 pixels through the 8 mask bytes at `m` */
+TARGET("avx2")
+static inline __m256i blend_mask8_avx2(__m256i p, const unsigned char *m,
+  __m256i src, __m256i ca, int scale)
+{
+  __m256i zero = _mm256_setzero_si256();
+  /* one mask byte per 32bit element, copied into both of its 16bit halves;
+  ** pixels 0-3 land in the low lane and 4-7 in the high lane, matching the
+  ** pixel unpacks */
+  __m256i a = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*) m));
+  a = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+  __m256i alo = _mm256_unpacklo_epi32(a, a);
+  __m256i ahi = _mm256_unpackhi_epi32(a, a);
+  if (scale) {
+    alo = div255_avx2(_mm256_mullo_epi16(alo, ca));
+    ahi = div255_avx2(_mm256_mullo_epi16(ahi, ca));
+  }
+  __m256i lo = blend_px_avx2(_mm256_unpacklo_epi8(p, zero), src, alo);
+  __m256i hi = blend_px_avx2(_mm256_unpackhi_epi8(p, zero), src, ahi);
+  return _mm256_packus_epi16(lo, hi);
+}
+
+
+/* selects the first `n` of 8 pixels for a masked load or store */
+TARGET("avx2")
+static inline __m256i tail_avx2(int n) {
+  return _mm256_cmpgt_epi32(
+    _mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+
+TARGET("avx2")
+static void fill_avx2(uint32_t *dst, int pitch, int w, int h, mu_Color color) {
+  __m256i v = _mm256_set1_epi32((int) pack_color(color));
+  __m256i tail = tail_avx2(w & 7);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    int x = 0;
+    for (; x + 8 <= w; x += 8) { _mm256_storeu_si256((__m256i*) (dst + x), v); }
+    if (x < w) { _mm256_maskstore_epi32((int*) (dst + x), tail, v); }
+  }
+}
+
+
+TARGET("avx2")
+static void blend_avx2(uint32_t *dst, int pitch, int w, int h,
+  mu_Color color)
+{
+  short sr = (short) (color.r * color.a), sg = (short) (color.g * color.a);
+  short sb = (short) (color.b * color.a), sa = (short) (255 * color.a);
+  __m256i src = _mm256_setr_epi16(sr, sg, sb, sa, sr, sg, sb, sa,
+                                  sr, sg, sb, sa, sr, sg, sb, sa);
+  __m256i inv = _mm256_set1_epi16(255 - color.a);
+  __m256i tail = tail_avx2(w & 7);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    int x = 0;
+    for (; x + 8 <= w; x += 8) {
+      __m256i *p = (__m256i*) (dst + x);
+      _mm256_storeu_si256(p, blend8_avx2(_mm256_loadu_si256(p), src, inv));
+    }
+    if (x < w) {
+      int *p = (int*) (dst + x);
+      __m256i v = _mm256_maskload_epi32(p, tail);
+      _mm256_maskstore_epi32(p, tail, blend8_avx2(v, src, inv));
+    }
+  }
+}
+
+
+TARGET("avx2")
+static void blend_mask_avx2(uint32_t *dst, int pitch,
+  const unsigned char *mask, int mask_pitch, int w, int h, mu_Color color)
+{
+  __m256i src = _mm256_setr_epi16(
+    color.r, color.g, color.b, 255, color.r, color.g, color.b, 255,
+    color.r, color.g, color.b, 255, color.r, color.g, color.b, 255);
+  __m256i ca = _mm256_set1_epi16(color.a);
+  __m256i tail = tail_avx2(w & 7);
+  int scale = color.a != 255;
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch), mask += mask_pitch) {
+    int x = 0;
+    uint64_t m;
+    for (; x + 8 <= w; x += 8) {
+      memcpy(&m, mask + x, sizeof(m));
+      if (m == 0) { continue; }
+      __m256i *p = (__m256i*) (dst + x);
+      _mm256_storeu_si256(p,
+        blend_mask8_avx2(_mm256_loadu_si256(p), mask + x, src, ca, scale));
+    }
+    if (x < w) {
+      m = 0;
+      memcpy(&m, mask + x, w - x);
+      if (m == 0) { continue; }
+      int *p = (int*) (dst + x);
+      __m256i v = _mm256_maskload_epi32(p, tail);
+      v = blend_mask8_avx2(v, (unsigned char*) &m, src, ca, scale);
+      _mm256_maskstore_epi32(p, tail, v);
+    }
+  }
+}
+
+
+static const sw_Kernels kernels_avx2 = {
+  "avx2", fill_avx2, blend_avx2, blend_mask_avx2
+};
+
+
+static int has_sse2(void) {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+  return 1;
+#elif defined(__GNUC__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2");
+#else
+  return 0;
+#endif
+}
+
+
+static int has_avx2(void) {
+#if defined(__GNUC__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+  int r[4];
+  __cpuid(r, 0);
+  if (r[0] < 7) { return 0; }
+  /* the OS must also save the upper halves of the ymm registers */
+  __cpuid(r, 1);
+  if ((r[2] & (3 << 27)) != (3 << 27)) { return 0; }
+  if ((_xgetbv(0) & 6) != 6) { return 0; }
+  __cpuidex(r, 7, 0);
+  return (r[1] >> 5) & 1;
+#else
+  return 0;
+#endif
+}
+
+#endif
+
+
+/*==============================================================================
+** NEON, 8 pixels at a time with the channels deinterleaved by vld4. the last
+** pixels of a row are staged through a buffer
+**============================================================================*/
+
+#ifdef SW_NEON
+
+/* same rounding as `div255()`: (x + ((x + 128) >> 8) + 128) >> 8 */
+static inline uint8x8_t div255_neon(uint16x8_t x) {
+  return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+}
+
+
+/* blends 8 pixels with the premultiplied source `s` */
+static inline void blend8_neon(uint8_t *d, const uint16x8_t *s, uint8x8_t inv) {
+  uint8x8x4_t p = vld4_u8(d);
+  for (int i = 0; i < 4; i++) {
+    p.val[i] = div255_neon(vmlal_u8(s[i], p.val[i], inv));
+  }
+  vst4_u8(d, p);
+}
+
+
+/* blends 8 pixels of the color `c` through the 8 mask bytes at `m` */
+static inline void blend_mask8_neon(uint8_t *d, const unsigned char *m,
+  const uint8x8_t *c, uint8x8_t ca, int scale)
+{
+  uint8x8_t a = vld1_u8(m);
+  if (scale) { a = div255_neon(vmull_u8(a, ca)); }
+  uint8x8_t inv = vmvn_u8(a);
+  uint8x8x4_t p = vld4_u8(d);
+  for (int i = 0; i < 4; i++) {
+    p.val[i] = div255_neon(vmlal_u8(vmull_u8(c[i], a), p.val[i], inv));
+  }
+  vst4_u8(d, p);
+}
+
+
+static void fill_neon(uint32_t *dst, int pitch, int w, int h, mu_Color color) {
+  uint32_t px = pack_color(color);
+  uint32x4_t v = vdupq_n_u32(px);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    int x = 0;
+    for (; x + 4 <= w; x += 4) { vst1q_u32(dst + x, v); }
+    for (; x < w; x++) { dst[x] = px; }
+  }
+}
+
+
+static void blend_neon(uint32_t *dst, int pitch, int w, int h,
+  mu_Color color)
+{
+  uint16x8_t s[4];
+  s[0] = vdupq_n_u16(color.r * color.a);
+  s[1] = vdupq_n_u16(color.g * color.a);
+  s[2] = vdupq_n_u16(color.b * color.a);
+  s[3] = vdupq_n_u16(255 * color.a);
+  uint8x8_t inv = vdup_n_u8(255 - color.a);
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch)) {
+    int x = 0;
+    for (; x + 8 <= w; x += 8) { blend8_neon((uint8_t*) (dst + x), s, inv); }
+    if (x < w) {
+      uint32_t buf[8];
+      memcpy(buf, dst + x, (w - x) * 4);
+      blend8_neon((uint8_t*) buf, s, inv);
+      memcpy(dst + x, buf, (w - x) * 4);
+    }
+  }
+}
+
+
+static void blend_mask_neon(uint32_t *dst, int pitch,
+  const unsigned char *mask, int mask_pitch, int w, int h, mu_Color color)
+{
+  uint8x8_t c[4];
+  c[0] = vdup_n_u8(color.r);
+  c[1] = vdup_n_u8(color.g);
+  c[2] = vdup_n_u8(color.b);
+  c[3] = vdup_n_u8(255);
+  uint8x8_t ca = vdup_n_u8(color.a);
+  int scale = color.a != 255;
+  for (int y = 0; y < h; y++, dst = next_row(dst, pitch), mask += mask_pitch) {
+    int x = 0;
+    uint64_t m;
+    for (; x + 8 <= w; x += 8) {
+      memcpy(&m, mask + x, sizeof(m));
+      if (m == 0) { continue; }
+      blend_mask8_neon((uint8_t*) (dst + x), mask + x, c, ca, scale);
+    }
+    if (x < w) {
+      uint32_t buf[8];
+      m = 0;
+      memcpy(&m, mask + x, w - x);
+      if (m == 0) { continue; }
+      memcpy(buf, dst + x, (w - x) * 4);
+      blend_mask8_neon((uint8_t*) buf, (unsigned char*) &m, c, ca, scale);
+      memcpy(dst + x, buf, (w - x) * 4);
+    }
+  }
+}
+
+
+static const sw_Kernels kernels_neon = {
+  "neon", fill_neon, blend_neon, blend_mask_neon
+};
+
+#endif
+
+
+/*==============================================================================
+** dispatch
+**============================================================================*/
+
+typedef struct {
+  const sw_Kernels *kernels;
+  int (*supported)(void);
+} Entry;
+
+static int always(void) { return 1; }
+
+/* in order of preference */
+static const Entry entries[] = {
+#ifdef SW_X86
+  { &kernels_avx2, has_avx2 },
+  { &kernels_sse2, has_sse2 },
+#endif
+#ifdef SW_NEON
+  { &kernels_neon, always },
+#endif
+  { &kernels_scalar, always }
+};
+
+/* set by the first call to `sw_kernels()`, or by `sw_kernels_use()`; neither
+** may race with rendering on other threads, so `sw_tiler_init()` makes the
+** first call before starting its own */
+static const sw_Kernels *active;
+
+
+const sw_Kernels* sw_kernels_list(int idx) {
+  int n = sizeof(entries) / sizeof(*entries);
+  for (int i = 0; i < n; i++) {
+    if (!entries[i].supported()) { continue; }
+    if (idx-- == 0) { return entries[i].kernels; }
+  }
+  return NULL;
+}
+
+
+const sw_Kernels* sw_kernels(void) {
+  if (!active) { active = sw_kernels_list(0); }
+  return active;
+}
+
+
+const sw_Kernels* sw_kernels_find(const char *name) {
+  const sw_Kernels *k;
+  for (int i = 0; (k = sw_kernels_list(i)); i++) {
+    if (!strcmp(k->name, name)) { return k; }
+  }
+  return NULL;
+}
+
+
+int sw_kernels_use(const char *name) {
+  const sw_Kernels *k = sw_kernels_find(name);
+  if (k) { active = k; }
+  return k != NULL;
+}
@@ -0,0 +1,33 @@
+#ifndef SWKERNELS_H
+#define SWKERNELS_H
+
+#include <stdint.h>
+#include "microui.h"
+
+/*
+** Pixel kernels used by the software renderer, each working on a `w` by `h`
+** block of RGBA8 pixels whose rows start `pitch` bytes apart. Scalar, SSE2,
+** AVX2 and NEON versions are compiled where the target allows and the best
+** one the CPU supports is picked at runtime. All of them give bit-identical
+** results: blending is `(c * a + d * (255 - a)) / 255`, rounded to nearest,
+** per channel, with the source alpha channel taken as 255.
+*/
+
+typedef struct {
+  const char *name;
+  /* stores `color` to the block */
+  void (*fill)(uint32_t *dst, int pitch, int w, int h, mu_Color color);
+  /* blends translucent `color` over the block */
+  void (*blend)(uint32_t *dst, int pitch, int w, int h, mu_Color color);
+  /* blends `color` over the block with each pixel's alpha scaled by the 8bit
+  ** coverage in `mask`, whose rows start `mask_pitch` bytes apart */
+  void (*blend_mask)(uint32_t *dst, int pitch, const unsigned char *mask,
+    int mask_pitch, int w, int h, mu_Color color);
+} sw_Kernels;
+
+const sw_Kernels* sw_kernels(void);
+const sw_Kernels* sw_kernels_find(const char *name);
+int sw_kernels_use(const char *name);
+const sw_Kernels* sw_kernels_list(int idx);
+
+#endif
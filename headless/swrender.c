@@ -0,0 +1,160 @@
+#include <stdint.h>
+#include <string.h>
+#include "swrender.h"
+#include "swkernels.h"
+#include "../demo/atlas.inl"
+
+#define TEXT_HEIGHT 18
+
+
+static mu_Rect intersect(mu_Rect a, mu_Rect b) {
+  int x1 = mu_max(a.x, b.x);
+  int y1 = mu_max(a.y, b.y);
+  int x2 = mu_min(a.x + a.w, b.x + b.w);
+  int y2 = mu_min(a.y + a.h, b.y + b.h);
+  if (x2 < x1) { x2 = x1; }
+  if (y2 < y1) { y2 = y1; }
+  return mu_rect(x1, y1, x2 - x1, y2 - y1);
+}
+
+
+static void fill_rect(sw_Target *t, mu_Rect r, mu_Color color) {
+  uint32_t *dst = (uint32_t*) (t->pixels + r.y * t->pitch + r.x * 4);
+  if (color.a == 0) { return; }
+  /* opaque: plain stores; translucent: blend */
+  if (color.a == 255) {
+    sw_kernels()->fill(dst, t->pitch, r.w, r.h, color);
+  } else {
+    sw_kernels()->blend(dst, t->pitch, r.w, r.h, color);
+  }
+}
+
+
+/* blends `color` through the alpha mask at `src` (atlas coordinates) into the
+** already-clipped destination rect `r` */
+static void blit_mask(sw_Target *t, mu_Rect r, int sx, int sy, mu_Color color) {
+  uint32_t *dst = (uint32_t*) (t->pixels + r.y * t->pitch + r.x * 4);
+  const unsigned char *mask = atlas_texture + sy * ATLAS_WIDTH + sx;
+  if (color.a == 0) { return; }
+  sw_kernels()->blend_mask(dst, t->pitch, mask, ATLAS_WIDTH, r.w, r.h, color);
+}
+
+
+static void draw_image(sw_Target *t, mu_Rect dst, mu_Rect src, mu_Color color,
+  mu_Rect clip)
+{
+  mu_Rect r = intersect(dst, clip);
+  if (r.w <= 0 || r.h <= 0) { return; }
+  blit_mask(t, r, src.x + r.x - dst.x, src.y + r.y - dst.y, color);
+}
+
+
+static void draw_text(sw_Target *t, const char *text, mu_Vec2 pos,
+  mu_Color color, mu_Rect clip)
+{
+  int x = pos.x;
+  int right = clip.x + clip.w;
+  /* whole line is above or below the clip rect */
+  if (pos.y >= clip.y + clip.h || pos.y + TEXT_HEIGHT <= clip.y) { return; }
+  for (const char *p = text; *p; p++) {
+    if ((*p & 0xc0) == 0x80) { continue; }
+    if (x >= right) { break; }
+    int chr = mu_min((unsigned char) *p, 127);
+    mu_Rect src = atlas[ATLAS_FONT + chr];
+    if (x + src.w > clip.x) {
+      draw_image(t, mu_rect(x, pos.y, src.w, src.h), src, color, clip);
+    }
+    x += src.w;
+  }
+}
+
+
+static mu_Rect icon_rect(int id, mu_Rect rect) {
+  mu_Rect src = atlas[id];
+  int x = rect.x + (rect.w - src.w) / 2;
+  int y = rect.y + (rect.h - src.h) / 2;
+  return mu_rect(x, y, src.w, src.h);
+}
+
+
+static void draw_icon(sw_Target *t, int id, mu_Rect rect, mu_Color color,
+  mu_Rect clip)
+{
+  draw_image(t, icon_rect(id, rect), atlas[id], color, clip);
+}
+
+
+void sw_clear(sw_Target *t, mu_Color color) {
+  sw_kernels()->fill((uint32_t*) t->pixels, t->pitch, t->width, t->height, color);
+}
+
+
+void sw_render(sw_Target *t, mu_Context *ctx) {
+  sw_render_region(t, ctx, mu_rect(0, 0, t->width, t->height));
+}
+
+
+void sw_render_region(sw_Target *t, mu_Context *ctx, mu_Rect region) {
+  mu_Rect base = intersect(region, mu_rect(0, 0, t->width, t->height));
+  mu_Rect clip = base;
+  mu_Command *cmd = NULL;
+  if (base.w <= 0 || base.h <= 0) { return; }
+
+  while (mu_next_command(ctx, &cmd)) {
+    if (cmd->type == MU_COMMAND_CLIP) {
+      clip = intersect(cmd->clip.rect, base);
+      continue;
+    }
+    if (clip.w <= 0 || clip.h <= 0) { continue; }
+    sw_draw_command(t, cmd, clip);
+  }
+}
+
+
+mu_Rect sw_command_rect(mu_Command *cmd) {
+  switch (cmd->type) {
+    case MU_COMMAND_RECT: return cmd->rect.rect;
+    case MU_COMMAND_ICON: return icon_rect(cmd->icon.id, cmd->icon.rect);
+    case MU_COMMAND_TEXT: {
+      int w = sw_text_width(NULL, cmd->text.str, -1);
+      return mu_rect(cmd->text.pos.x, cmd->text.pos.y, w, TEXT_HEIGHT);
+    }
+  }
+  return mu_rect(0, 0, 0, 0);
+}
+
+
+void sw_draw_command(sw_Target *t, mu_Command *cmd, mu_Rect clip) {
+  switch (cmd->type) {
+    case MU_COMMAND_RECT: {
+      mu_Rect r = intersect(cmd->rect.rect, clip);
+      if (r.w > 0 && r.h > 0) { fill_rect(t, r, cmd->rect.color); }
+      break;
+    }
+    case MU_COMMAND_TEXT:
+      draw_text(t, cmd->text.str, cmd->text.pos, cmd->text.color, clip);
+      break;
+    case MU_COMMAND_ICON:
+      draw_icon(t, cmd->icon.id, cmd->icon.rect, cmd->icon.color, clip);
+      break;
+  }
+}
+
+
+int sw_text_width(mu_Font font, const char *text, int len) {
+  int res = 0;
+  (void) font;
+  if (len < 0) { len = strlen(text); }
+  for (const char *p = text; len-- > 0 && *p; p++) {
+    if ((*p & 0xc0) == 0x80) { continue; }
+    int chr = mu_min((unsigned char) *p, 127);
+    res += atlas[ATLAS_FONT + chr].w;
+  }
+  return res;
+}
+
+
+int sw_text_height(mu_Font font) {
+  (void) font;
+  return TEXT_HEIGHT;
+}
@@ -0,0 +1,20 @@
+#ifndef SWRENDER_H
+#define SWRENDER_H
+
+#include "microui.h"
+
+typedef struct {
+  unsigned char *pixels; /* caller-owned RGBA8 pixels */
+  int width, height;
+  int pitch;             /* bytes per row */
+} sw_Target;
+
+void sw_clear(sw_Target *t, mu_Color color);
+void sw_render(sw_Target *t, mu_Context *ctx);
+void sw_render_region(sw_Target *t, mu_Context *ctx, mu_Rect region);
+mu_Rect sw_command_rect(mu_Command *cmd);
+void sw_draw_command(sw_Target *t, mu_Command *cmd, mu_Rect clip);
+int sw_text_width(mu_Font font, const char *text, int len);
+int sw_text_height(mu_Font font);
+
+#endif
@@ -0,0 +1,234 @@
+#include <stdlib.h>
+#include <string.h>
+#include "swtiles.h"
+#include "swkernels.h"
+
+
+static mu_Rect intersect(mu_Rect a, mu_Rect b) {
+  int x1 = mu_max(a.x, b.x);
+  int y1 = mu_max(a.y, b.y);
+  int x2 = mu_min(a.x + a.w, b.x + b.w);
+  int y2 = mu_min(a.y + a.h, b.y + b.h);
+  if (x2 < x1) { x2 = x1; }
+  if (y2 < y1) { y2 = y1; }
+  return mu_rect(x1, y1, x2 - x1, y2 - y1);
+}
+
+
+/* grows `*ptr` to hold at least `n` elements of `size` bytes */
+static int reserve(void *ptr, int *cap, int n, int size) {
+  void **p = ptr;
+  if (n <= *cap) { return 1; }
+  int c = mu_max(n, mu_max(*cap * 2, 64));
+  void *res = realloc(*p, (size_t) c * size);
+  if (!res) { return 0; }
+  *p = res;
+  *cap = c;
+  return 1;
+}
+
+
+/* sorts the drawing commands of the frame into the tiles they touch. each
+** tile's references are counted first and then written from the last item
+** back, so every tile lists its items in drawing order */
+static int bin(sw_Tiler *tl, mu_Context *ctx) {
+  sw_Target *t = tl->target;
+  mu_Rect base = mu_rect(0, 0, t->width, t->height), clip = base;
+  mu_Command *cmd = NULL;
+  int ts = tl->tile_size, n = 0, total = 0;
+
+  tl->cols = (t->width + ts - 1) / ts;
+  tl->rows = (t->height + ts - 1) / ts;
+  int tiles = tl->cols * tl->rows;
+  if (!reserve(&tl->offsets, &tl->tile_cap, tiles + 1, sizeof(int))) {
+    return 0;
+  }
+  memset(tl->offsets, 0, (tiles + 1) * sizeof(int));
+
+  while (mu_next_command(ctx, &cmd)) {
+    if (cmd->type == MU_COMMAND_CLIP) {
+      clip = intersect(cmd->clip.rect, base);
+      continue;
+    }
+    mu_Rect r = intersect(sw_command_rect(cmd), clip);
+    if (r.w <= 0 || r.h <= 0) { continue; }
+    int cap = tl->item_cap;
+    if (!reserve(&tl->items, &cap, n + 1, sizeof(*tl->items)) ||
+        !reserve(&tl->ranges, &tl->item_cap, n + 1, 4 * sizeof(int))
+    ) {
+      return 0;
+    }
+    tl->items[n].cmd = cmd;
+    tl->items[n].clip = clip;
+    int *range = &tl->ranges[n * 4];
+    range[0] = r.x / ts;
+    range[1] = r.y / ts;
+    range[2] = (r.x + r.w - 1) / ts;
+    range[3] = (r.y + r.h - 1) / ts;
+    for (int y = range[1]; y <= range[3]; y++) {
+      for (int x = range[0]; x <= range[2]; x++) {
+        tl->offsets[y * tl->cols + x]++;
+      }
+    }
+    total += (range[2] - range[0] + 1) * (range[3] - range[1] + 1);
+    n++;
+  }
+  tl->item_count = n;
+
+  /* offsets become the end of each tile's references, and are moved back to
+  ** their start as the references are written */
+  for (int i = 1; i < tiles; i++) { tl->offsets[i] += tl->offsets[i - 1]; }
+  tl->offsets[tiles] = total;
+  if (!reserve(&tl->refs, &tl->ref_cap, total, sizeof(int))) { return 0; }
+  for (int i = n - 1; i >= 0; i--) {
+    int *range = &tl->ranges[i * 4];
+    for (int y = range[1]; y <= range[3]; y++) {
+      for (int x = range[0]; x <= range[2]; x++) {
+        tl->refs[--tl->offsets[y * tl->cols + x]] = i;
+      }
+    }
+  }
+  return 1;
+}
+
+
+static void render_tile(sw_Tiler *tl, int tile) {
+  sw_Target *t = tl->target;
+  int ts = tl->tile_size;
+  mu_Rect rect = mu_rect((tile % tl->cols) * ts, (tile / tl->cols) * ts, ts, ts);
+  rect = intersect(rect, mu_rect(0, 0, t->width, t->height));
+  if (tl->clear) {
+    uint32_t *dst = (uint32_t*) (t->pixels + rect.y * t->pitch + rect.x * 4);
+    sw_kernels()->fill(dst, t->pitch, rect.w, rect.h, *tl->clear);
+  }
+  for (int i = tl->offsets[tile]; i < tl->offsets[tile + 1]; i++) {
+    sw_TileItem *item = &tl->items[tl->refs[i]];
+    sw_draw_command(t, item->cmd, intersect(item->clip, rect));
+  }
+}
+
+
+/* draws the tiles of the thread's own run, then helps the others with
+** theirs. tiles are claimed by incrementing a run's cursor, so each is drawn
+** exactly once whichever thread gets to it */
+static void work(sw_TileWorker *w) {
+  sw_Tiler *tl = w->tiler;
+  int self = w - tl->workers, tile;
+  w->rendered = w->stolen = 0;
+  for (int i = 0; i < tl->threads; i++) {
+    sw_TileWorker *v = &tl->workers[(self + i) % tl->threads];
+    while ((tile = atomic_fetch_add_explicit(&v->next, 1, memory_order_relaxed))
+        < v->end
+    ) {
+      render_tile(tl, tile);
+      w->rendered++;
+      if (v != w) { w->stolen++; }
+    }
+  }
+}
+
+
+static void* thread_main(void *arg) {
+  sw_TileWorker *w = arg;
+  sw_Tiler *tl = w->tiler;
+  /* threads are created before the first frame, whether or not they get to
+  ** run before it is started */
+  int generation = 0;
+  pthread_mutex_lock(&tl->lock);
+  for (;;) {
+    while (tl->generation == generation && !tl->quit) {
+      pthread_cond_wait(&tl->start, &tl->lock);
+    }
+    if (tl->quit) { break; }
+    generation = tl->generation;
+    pthread_mutex_unlock(&tl->lock);
+    work(w);
+    pthread_mutex_lock(&tl->lock);
+    if (--tl->pending == 0) { pthread_cond_signal(&tl->done); }
+  }
+  pthread_mutex_unlock(&tl->lock);
+  return NULL;
+}
+
+
+int sw_tiler_init(sw_Tiler *tl, int threads, int tile_size) {
+  memset(tl, 0, sizeof(*tl));
+  tl->threads = mu_max(threads, 1);
+  tl->tile_size = tile_size > 0 ? tile_size : SW_TILE_SIZE;
+  tl->workers = aligned_alloc(SW_CACHE_LINE,
+    tl->threads * sizeof(*tl->workers));
+  tl->handles = calloc(tl->threads, sizeof(*tl->handles));
+  if (!tl->workers || !tl->handles) { sw_tiler_deinit(tl); return 0; }
+  memset(tl->workers, 0, tl->threads * sizeof(*tl->workers));
+  /* resolve the kernels once, before any thread can be first to use them */
+  sw_kernels();
+  pthread_mutex_init(&tl->lock, NULL);
+  pthread_cond_init(&tl->start, NULL);
+  pthread_cond_init(&tl->done, NULL);
+  /* the caller is worker 0; if threads can't be created the frame is split
+  ** between those that were */
+  for (int i = 0; i < tl->threads; i++) { tl->workers[i].tiler = tl; }
+  for (int i = 1; i < tl->threads; i++) {
+    if (pthread_create(&tl->handles[i], NULL, thread_main, &tl->workers[i])) {
+      tl->threads = i;
+      break;
+    }
+  }
+  return 1;
+}
+
+
+void sw_tiler_deinit(sw_Tiler *tl) {
+  if (tl->workers && tl->handles) {
+    pthread_mutex_lock(&tl->lock);
+    tl->quit = 1;
+    pthread_cond_broadcast(&tl->start);
+    pthread_mutex_unlock(&tl->lock);
+    for (int i = 1; i < tl->threads; i++) { pthread_join(tl->handles[i], NULL); }
+    pthread_mutex_destroy(&tl->lock);
+    pthread_cond_destroy(&tl->start);
+    pthread_cond_destroy(&tl->done);
+  }
+  free(tl->workers);
+  free(tl->handles);
+  free(tl->offsets);
+  free(tl->refs);
+  free(tl->ranges);
+  free(tl->items);
+  memset(tl, 0, sizeof(*tl));
+}
+
+
+void sw_tiler_render(sw_Tiler *tl, sw_Target *t, mu_Context *ctx,
+  const mu_Color *clear)
+{
+  tl->target = t;
+  tl->clear = clear;
+  if (!bin(tl, ctx)) {
+    if (clear) { sw_clear(t, *clear); }
+    sw_render(t, ctx);
+    return;
+  }
+
+  /* give each thread an equal run of tiles */
+  int tiles = tl->cols * tl->rows;
+  for (int i = 0; i < tl->threads; i++) {
+    sw_TileWorker *w = &tl->workers[i];
+    atomic_store_explicit(&w->next, tiles * i / tl->threads, memory_order_relaxed);
+    w->end = tiles * (i + 1) / tl->threads;
+  }
+
+  if (tl->threads > 1) {
+    pthread_mutex_lock(&tl->lock);
+    tl->generation++;
+    tl->pending = tl->threads - 1;
+    pthread_cond_broadcast(&tl->start);
+    pthread_mutex_unlock(&tl->lock);
+  }
+  work(&tl->workers[0]);
+  if (tl->threads > 1) {
+    pthread_mutex_lock(&tl->lock);
+    while (tl->pending > 0) { pthread_cond_wait(&tl->done, &tl->lock); }
+    pthread_mutex_unlock(&tl->lock);
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef SWTILES_H
+#define SWTILES_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include "swrender.h"
+
+/*
+** Renders the command list of a finished frame on several threads. The
+** commands are binned into square screen tiles, keeping their order within
+** each tile, and tiles are then drawn independently, so no two threads write
+** the same pixel. Each thread starts on its own run of tiles and steals from
+** the others once its own run is done. Output is identical to `sw_render()`.
+**
+**   sw_Tiler tl;
+**   sw_tiler_init(&tl, 8, 0);
+**   ...
+**   mu_end(ctx);
+**   sw_tiler_render(&tl, &target, ctx, &background);
+**   ...
+**   sw_tiler_deinit(&tl);
+*/
+
+#define SW_TILE_SIZE 64
+
+typedef struct sw_Tiler sw_Tiler;
+
+typedef struct { mu_Command *cmd; mu_Rect clip; } sw_TileItem;
+
+#define SW_CACHE_LINE 64
+
+/* aligned, and allocated, to a cache line each so the cursors of threads
+** never share one */
+typedef struct {
+  _Alignas(SW_CACHE_LINE) sw_Tiler *tiler;
+  atomic_int next; /* next tile of this thread's run to be claimed */
+  int end;
+  int rendered, stolen; /* tiles drawn by this thread in the last frame */
+} sw_TileWorker;
+
+struct sw_Tiler {
+  int threads;   /* including the caller of `sw_tiler_render()` */
+  int tile_size;
+  /* bins of the current frame */
+  int cols, rows;
+  int *offsets;    /* start of each tile's references, plus the end */
+  int *refs;       /* indices into `items` */
+  int *ranges;     /* tile range of each item, 4 ints each */
+  sw_TileItem *items;
+  int item_count, item_cap, ref_cap, tile_cap;
+  sw_Target *target;
+  const mu_Color *clear;
+  /* thread pool */
+  sw_TileWorker *workers;
+  pthread_t *handles;
+  pthread_mutex_t lock;
+  pthread_cond_t start, done;
+  int generation, pending, quit;
+};
+
+int sw_tiler_init(sw_Tiler *tl, int threads, int tile_size);
+void sw_tiler_deinit(sw_Tiler *tl);
+void sw_tiler_render(sw_Tiler *tl, sw_Target *t, mu_Context *ctx,
+  const mu_Color *clear);
+
+#endif
@@ -20,6 +20,8 @@
 ** IN THE SOFTWARE.
 */
 
+#include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -36,9 +38,10 @@
   } while (0)
 
 #define push(stk, val) do {                                                 \
-    expect((stk).idx < (int) (sizeof((stk).items) / sizeof(*(stk).items))); \
+    expect((stk).idx < (stk).cap);                                           \
     (stk).items[(stk).idx] = (val);                                         \
     (stk).idx++; /* incremented after incase `val` uses this value */       \
+    track((stk).peak = mu_max((stk).peak, (stk).idx));                      \
   } while (0)
 
 #define pop(stk) do {      \
@@ -46,6 +49,13 @@
     (stk).idx--;           \
   } while (0)
 
+/* evaluates its argument only when compiled with MU_STATS */
+#ifdef MU_STATS
+  #define track(x) (x)
+#else
+  #define track(x)
+#endif
+
 
 static mu_Rect unclipped_rect = { 0, 0, 0x1000000, 0x1000000 };
 
@@ -110,11 +120,70 @@ static mu_Rect intersect_rects(mu_Rect r1, mu_Rect r2) {
 }
 
 
+static int rects_equal(mu_Rect a, mu_Rect b) {
+  return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+
 static int rect_overlaps_vec2(mu_Rect r, mu_Vec2 p) {
   return p.x >= r.x && p.x < r.x + r.w && p.y >= r.y && p.y < r.y + r.h;
 }
 
 
+static int rects_overlap(mu_Rect a, mu_Rect b) {
+  return a.x < b.x + b.w && b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+
+static mu_Rect union_rects(mu_Rect a, mu_Rect b) {
+  int x1 = mu_min(a.x, b.x);
+  int y1 = mu_min(a.y, b.y);
+  int x2 = mu_max(a.x + a.w, b.x + b.w);
+  int y2 = mu_max(a.y + a.h, b.y + b.h);
+  return mu_rect(x1, y1, x2 - x1, y2 - y1);
+}
+
+
+/* rotate-xor-multiply hash over words of `mu_Id` size: 32bit, or 64bit if
+** MU_ID64 is defined */
+#ifdef MU_ID64
+  #define HASH_INITIAL 14695981039346656037ULL
+  #define HASH_PRIME   0x517cc1b727220a95ULL
+#else
+  #define HASH_INITIAL 2166136261
+  #define HASH_PRIME   0x9e3779b9
+#endif
+
+/* one step of the hash, mixing in a word or byte. the state is rotated first
+** so the high bits of earlier words also reach the low bits of the result */
+#define hash_step(h, w) \
+  ((((h) << 5) | ((h) >> (sizeof(mu_Id) * 8 - 5))) ^ (w)) * HASH_PRIME
+
+static void hash(mu_Id *hash, const void *data, int size) {
+  const unsigned char *p = data;
+  mu_Id h = *hash, w;
+  int i = 0;
+  /* hash whole words at a time, then the remaining bytes */
+  for (; i + (int) sizeof(w) <= size; i += sizeof(w)) {
+    memcpy(&w, p + i, sizeof(w));
+    h = hash_step(h, w);
+  }
+  for (; i < size; i++) { h = hash_step(h, p[i]); }
+  *hash = h;
+}
+
+
+/* finalizes an id for use as a table index, spreading every bit of it to the
+** low bits */
+static unsigned mix_id(mu_Id id) {
+  unsigned h = (unsigned) (id ^ (id >> 16 >> 16));
+  h ^= h >> 16; h *= 0x7feb352d;
+  h ^= h >> 15; h *= 0x846ca68b;
+  h ^= h >> 16;
+  return h;
+}
+
+
 static void draw_frame(mu_Context *ctx, mu_Rect rect, int colorid) {
   mu_draw_rect(ctx, rect, ctx->style->colors[colorid]);
   if (colorid == MU_COLOR_SCROLLBASE  ||
@@ -127,24 +196,348 @@ static void draw_frame(mu_Context *ctx, mu_Rect rect, int colorid) {
 }
 
 
-void mu_init(mu_Context *ctx) {
-  memset(ctx, 0, sizeof(*ctx));
+/* measures text through the context's `text_cache` if it has one. the cache is
+** 4-way set associative; a miss replaces the entry of the set which was used
+** least recently. entries keep their strings, so only strings of up to
+** `MU_TEXTCACHE_KEYSIZE` bytes are cached */
+static int text_width(mu_Context *ctx, mu_Font font, const char *str, int len) {
+  mu_TextCache *tc = ctx->text_cache;
+  mu_TextCacheItem *item, *victim;
+  mu_Id h = HASH_INITIAL;
+  int i;
+  if (!tc) {
+    track(ctx->stats.text_width_calls++);
+    return ctx->text_width(font, str, len);
+  }
+  if (len < 0) { len = strlen(str); }
+  if (len > MU_TEXTCACHE_KEYSIZE) {
+    tc->misses++;
+    track(ctx->stats.text_width_calls++);
+    return ctx->text_width(font, str, len);
+  }
+  hash(&h, str, len);
+  hash(&h, &font, sizeof(font));
+  item = victim = &tc->items[(mix_id(h) % (MU_TEXTCACHE_SIZE / 4)) * 4];
+  for (i = 0; i < 4; i++, item++) {
+    if (item->hash == h && item->len == len && item->font == font &&
+        !memcmp(item->text, str, len)
+    ) {
+      item->last_used = ctx->frame;
+      tc->hits++;
+      return item->width;
+    }
+    if (item->last_used < victim->last_used) { victim = item; }
+  }
+  tc->misses++;
+  victim->hash = h;
+  victim->font = font;
+  victim->len = len;
+  memcpy(victim->text, str, len);
+  track(ctx->stats.text_width_calls++);
+  victim->width = ctx->text_width(font, str, len);
+  victim->last_used = ctx->frame;
+  return victim->width;
+}
+
+
+static int text_height(mu_Context *ctx, mu_Font font) {
+  track(ctx->stats.text_height_calls++);
+  return ctx->text_height(font);
+}
+
+
+static const mu_Config default_config = {
+  MU_COMMANDLIST_SIZE,
+  MU_ROOTLIST_SIZE,
+  MU_CONTAINERSTACK_SIZE,
+  MU_CLIPSTACK_SIZE,
+  MU_IDSTACK_SIZE,
+  MU_LAYOUTSTACK_SIZE,
+  MU_DAMAGELIST_SIZE,
+  MU_CONTAINERPOOL_SIZE,
+  MU_TREENODEPOOL_SIZE,
+  MU_EVENTQUEUE_SIZE
+};
+
+
+static mu_Config get_config(const mu_Config *cfg) {
+  mu_Config res = default_config;
+  if (!cfg) { return res; }
+#define set(x) if (cfg->x > 0) { res.x = cfg->x; }
+  set(command_list_size);
+  set(root_list_size);
+  set(container_stack_size);
+  set(clip_stack_size);
+  set(id_stack_size);
+  set(layout_stack_size);
+  set(damage_list_size);
+  set(container_pool_size);
+  set(treenode_pool_size);
+  set(event_queue_size);
+#undef set
+  return res;
+}
+
+
+/* places the arrays of a context one after another in `mem`, each aligned to 8
+** bytes; with `mem` NULL only the size is computed. returns the bytes used */
+static int layout_memory(mu_Context *ctx, const mu_Config *cfg, char *mem) {
+  int n = 0;
+#define carve(dst, size) do {              \
+    if (mem) { (dst) = (void*) (mem + n); } \
+    n += ((int) (size) + 7) & ~7;          \
+  } while (0)
+#define carve_array(dst, count) carve(dst, sizeof(*(dst)) * (count))
+  carve(ctx->command_list.head, sizeof(mu_CommandChunk) + cfg->command_list_size);
+  carve_array(ctx->root_list.items, cfg->root_list_size);
+  carve_array(ctx->last_root_list.items, cfg->root_list_size);
+  carve_array(ctx->damage_list.items, cfg->damage_list_size);
+  carve_array(ctx->container_stack.items, cfg->container_stack_size);
+  carve_array(ctx->clip_stack.items, cfg->clip_stack_size);
+  carve_array(ctx->id_stack.items, cfg->id_stack_size);
+  carve_array(ctx->layout_stack.items, cfg->layout_stack_size);
+  carve_array(ctx->container_pool.items, cfg->container_pool_size);
+  carve_array(ctx->container_pool.table,
+    MU_POOL_TABLESIZE(cfg->container_pool_size));
+  carve_array(ctx->containers, cfg->container_pool_size);
+  carve_array(ctx->treenode_pool.items, cfg->treenode_pool_size);
+  carve_array(ctx->treenode_pool.table,
+    MU_POOL_TABLESIZE(cfg->treenode_pool_size));
+  carve_array(ctx->event_queue.items, cfg->event_queue_size);
+#ifdef MU_STATS
+  carve_array(ctx->stats.roots, cfg->root_list_size);
+  carve_array(ctx->last_stats.roots, cfg->root_list_size);
+#endif
+#undef carve_array
+#undef carve
+  return n;
+}
+
+
+/* initialises a zeroed context whose arrays have been placed */
+static void init(mu_Context *ctx, const mu_Config *cfg) {
   ctx->draw_frame = draw_frame;
   ctx->_style = default_style;
   ctx->style = &ctx->_style;
+  ctx->command_list.head->next = NULL;
+  ctx->command_list.head->size = cfg->command_list_size;
+  ctx->root_list.cap = cfg->root_list_size;
+  ctx->last_root_list.cap = cfg->root_list_size;
+  ctx->damage_list.cap = cfg->damage_list_size;
+  ctx->container_stack.cap = cfg->container_stack_size;
+  ctx->clip_stack.cap = cfg->clip_stack_size;
+  ctx->id_stack.cap = cfg->id_stack_size;
+  ctx->layout_stack.cap = cfg->layout_stack_size;
+  ctx->event_queue.cap = cfg->event_queue_size;
+  mu_pool_setup(&ctx->container_pool, ctx->container_pool.items,
+    ctx->container_pool.table, cfg->container_pool_size);
+  memset(ctx->containers, 0, cfg->container_pool_size * sizeof(mu_Container));
+  mu_pool_setup(&ctx->treenode_pool, ctx->treenode_pool.items,
+    ctx->treenode_pool.table, cfg->treenode_pool_size);
+}
+
+
+#ifndef MU_SLIM
+void mu_init(mu_Context *ctx) {
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->command_list.head = &ctx->_storage.commands.chunk;
+  ctx->root_list.items = ctx->_storage.root_list;
+  ctx->last_root_list.items = ctx->_storage.last_root_list;
+  ctx->damage_list.items = ctx->_storage.damage_list;
+  ctx->container_stack.items = ctx->_storage.container_stack;
+  ctx->clip_stack.items = ctx->_storage.clip_stack;
+  ctx->id_stack.items = ctx->_storage.id_stack;
+  ctx->layout_stack.items = ctx->_storage.layout_stack;
+  ctx->container_pool.items = ctx->_storage.container_items;
+  ctx->container_pool.table = ctx->_storage.container_table;
+  ctx->containers = ctx->_storage.containers;
+  ctx->treenode_pool.items = ctx->_storage.treenode_items;
+  ctx->treenode_pool.table = ctx->_storage.treenode_table;
+  ctx->event_queue.items = ctx->_storage.event_queue;
+#ifdef MU_STATS
+  ctx->stats.roots = ctx->_storage.root_stats[0];
+  ctx->last_stats.roots = ctx->_storage.root_stats[1];
+#endif
+  init(ctx, &default_config);
+}
+#endif
+
+
+int mu_memory_size(const mu_Config *cfg) {
+  mu_Config c = get_config(cfg);
+  return layout_memory(NULL, &c, NULL);
+}
+
+
+void mu_init_ex(mu_Context *ctx, const mu_Config *cfg, void *mem) {
+  mu_Config c = get_config(cfg);
+  expect(mem);
+  memset(ctx, 0, sizeof(*ctx));
+  layout_memory(ctx, &c, mem);
+  init(ctx, &c);
+}
+
+
+void mu_deinit(mu_Context *ctx) {
+  mu_CommandChunk *chunk = ctx->command_list.head->next;
+  int i;
+  while (chunk) {
+    mu_CommandChunk *next = chunk->next;
+    ctx->alloc(ctx, chunk, 0);
+    chunk = next;
+  }
+  ctx->command_list.head->next = NULL;
+  /* free cached window segments */
+  for (i = 0; i < ctx->container_pool.len; i++) {
+    mu_WindowCache *c = ctx->containers[i].cache;
+    if (!c) { continue; }
+    if (c->items) { ctx->alloc(ctx, c->items, 0); }
+    ctx->alloc(ctx, c, 0);
+    ctx->containers[i].cache = NULL;
+  }
+  /* free the event queue if it was grown */
+  if (ctx->event_queue.grown) {
+    ctx->alloc(ctx, ctx->event_queue.items, 0);
+    ctx->event_queue.items = NULL;
+    ctx->event_queue.cap = ctx->event_queue.count = 0;
+    ctx->event_queue.grown = 0;
+  }
+  /* free the wrapped text cache's arrays */
+  for (i = 0; ctx->wrap_cache && i < MU_WRAPCACHE_SIZE; i++) {
+    mu_WrapCacheItem *item = &ctx->wrap_cache->items[i];
+    if (item->words) { ctx->alloc(ctx, item->words, 0); }
+    if (item->lines) { ctx->alloc(ctx, item->lines, 0); }
+    if (item->next_lines) { ctx->alloc(ctx, item->next_lines, 0); }
+    memset(item, 0, sizeof(*item));
+  }
+}
+
+
+/* input is queued as events in the order it arrives, and applied to the
+** input state by `mu_begin()` */
+
+static mu_Event* event_at(mu_EventQueue *q, int i) {
+  return &q->items[(q->first + i) % q->cap];
+}
+
+
+static void apply_event(mu_Context *ctx, mu_Event *e) {
+  int len, n;
+  switch (e->type) {
+    case MU_EVENT_MOUSEMOVE:
+      ctx->mouse_pos = e->pos;
+      break;
+    case MU_EVENT_MOUSEDOWN:
+      ctx->mouse_pos = e->pos;
+      ctx->mouse_down |= e->value;
+      ctx->mouse_pressed |= e->value;
+      break;
+    case MU_EVENT_MOUSEUP:
+      ctx->mouse_pos = e->pos;
+      ctx->mouse_down &= ~e->value;
+      break;
+    case MU_EVENT_SCROLL:
+      ctx->scroll_delta.x += e->pos.x;
+      ctx->scroll_delta.y += e->pos.y;
+      break;
+    case MU_EVENT_KEYDOWN:
+      ctx->key_pressed |= e->value;
+      ctx->key_down |= e->value;
+      break;
+    case MU_EVENT_KEYUP:
+      ctx->key_down &= ~e->value;
+      break;
+    case MU_EVENT_TEXT:
+      len = strlen(ctx->input_text);
+      n = strlen(e->text);
+      if (len + n < (int) sizeof(ctx->input_text)) {
+        memcpy(ctx->input_text + len, e->text, n + 1);
+      }
+      break;
+  }
+}
+
+
+/* applies queued events in order until one would be merged with another of
+** the same frame: a second change of a mouse button or key, a move after a
+** button changed, or text and presses of keys other than modifiers
+** interleaved. those left stay queued for the next frames, so no press or
+** release is lost */
+static void apply_events(mu_Context *ctx) {
+  enum { MODIFIERS = MU_KEY_SHIFT | MU_KEY_CTRL | MU_KEY_ALT };
+  mu_EventQueue *q = &ctx->event_queue;
+  int buttons = 0, keys = 0, pressed = 0, text = 0, len;
+  mu_Event *e;
+  /* drop the events of the last frame */
+  q->first = (q->first + q->applied) % q->cap;
+  q->count -= q->applied;
+  q->applied = 0;
+
+  for (; q->applied < q->count; q->applied++) {
+    e = event_at(q, q->applied);
+    switch (e->type) {
+      case MU_EVENT_MOUSEMOVE:
+        if (buttons) { return; }
+        break;
+      case MU_EVENT_MOUSEDOWN:
+      case MU_EVENT_MOUSEUP:
+        if (buttons & e->value) { return; }
+        buttons |= e->value;
+        break;
+      case MU_EVENT_KEYDOWN:
+      case MU_EVENT_KEYUP:
+        if (keys & e->value) { return; }
+        if (e->type == MU_EVENT_KEYDOWN && e->value & ~MODIFIERS) {
+          if (text) { return; }
+          pressed = 1;
+        }
+        keys |= e->value;
+        break;
+      case MU_EVENT_TEXT:
+        len = strlen(ctx->input_text) + strlen(e->text);
+        if (pressed || len >= (int) sizeof(ctx->input_text)) {
+          return;
+        }
+        text = 1;
+        break;
+    }
+    apply_event(ctx, e);
+  }
+}
+
+
+static void reset_commands(mu_Context *ctx) {
+  mu_CommandList *cl = &ctx->command_list;
+  cl->chunk = cl->head;
+  cl->items = (char*) (cl->head + 1);
+  cl->size = cl->head->size;
+  cl->idx = cl->total = 0;
+  ctx->command_clip = unclipped_rect;
 }
 
 
 void mu_begin(mu_Context *ctx) {
   expect(ctx->text_width && ctx->text_height);
-  ctx->command_list.idx = 0;
+  reset_commands(ctx);
   ctx->root_list.idx = 0;
   ctx->scroll_target = NULL;
   ctx->hover_root = ctx->next_hover_root;
   ctx->next_hover_root = NULL;
+  apply_events(ctx);
   ctx->mouse_delta.x = ctx->mouse_pos.x - ctx->last_mouse_pos.x;
   ctx->mouse_delta.y = ctx->mouse_pos.y - ctx->last_mouse_pos.y;
   ctx->frame++;
+  ctx->frame_flags = 0;
+  ctx->frame_delay = -1;
+#ifdef MU_STATS
+  {
+    mu_RootStats *roots = ctx->last_stats.roots;
+    ctx->last_stats = ctx->stats;
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+    ctx->stats.roots = roots;
+    ctx->stats.current_root = -1;
+  }
+#endif
 }
 
 
@@ -153,8 +546,127 @@ static int compare_zindex(const void *a, const void *b) {
 }
 
 
-void mu_end(mu_Context *ctx) {
+/* sorts the root list by zindex. the order of last frame is kept for roots
+** sorted then whose zindex has not changed since, so only roots which are
+** new, reopened or were brought to front are sorted, and merged in. this
+** keeps the sort linear in the number of roots when most stay put */
+static void sort_roots(mu_Context *ctx) {
+  mu_Container **items = ctx->root_list.items;
+  mu_Container **last = ctx->last_root_list.items;
+  int i, j, k, m = 0, n = ctx->root_list.idx;
+  /* mark the roots which keep their order, moving the rest to the front */
+  for (i = 0; i < n; i++) {
+    mu_Container *cnt = items[i];
+    if (ctx->last_root_list.idx > 0 && cnt->sort_frame == ctx->frame - 1 &&
+        cnt->sort_zindex == cnt->zindex
+    ) {
+      cnt->sort_frame = ctx->frame;
+    } else {
+      items[m++] = cnt;
+    }
+  }
+  qsort(items, m, sizeof(mu_Container*), compare_zindex);
+  /* merge from the back with the marked roots, taken from last frame's list */
+  i = m - 1;
+  j = ctx->last_root_list.idx - 1;
+  for (k = n - 1; k > i; k--) {
+    while (last[j]->sort_frame != ctx->frame) { j--; }
+    if (i >= 0 && items[i]->zindex > last[j]->zindex) {
+      items[k] = items[i--];
+    } else {
+      items[k] = last[j--];
+    }
+  }
+  for (i = 0; i < n; i++) {
+    items[i]->sort_frame = ctx->frame;
+    items[i]->sort_zindex = items[i]->zindex;
+  }
+}
+
+
+static mu_Id hash_segment(mu_Container *cnt) {
+  mu_Id res = HASH_INITIAL;
+  mu_Command *cmd = (mu_Command*) ((char*) cnt->head + sizeof(mu_JumpCommand));
+  while (cmd != cnt->tail) {
+    /* jumps inside a segment skip over nested root containers */
+    if (cmd->type == MU_COMMAND_JUMP) {
+      cmd = cmd->jump.dst;
+      continue;
+    }
+    /* only hash a text command up to its terminating null; the bytes after it
+    ** are struct padding */
+    if (cmd->type == MU_COMMAND_TEXT) {
+      hash(&res, cmd, cmd->base.size - sizeof(mu_TextCommand) +
+        offsetof(mu_TextCommand, str));
+    } else {
+      hash(&res, cmd, cmd->base.size);
+    }
+    cmd = (mu_Command*) (((char*) cmd) + cmd->base.size);
+  }
+  hash(&res, &cnt->zindex, sizeof(cnt->zindex));
+  hash(&res, &cnt->draw_rect, sizeof(cnt->draw_rect));
+  return res;
+}
+
+
+static void add_damage(mu_Context *ctx, mu_Rect rect) {
+  int i, n = ctx->damage_list.idx;
+  if (rect.w <= 0 || rect.h <= 0) { return; }
+  /* merge into an overlapping rect; if the list is full merge into the last */
+  for (i = 0; i < n; i++) {
+    mu_Rect *r = &ctx->damage_list.items[i];
+    if (rects_overlap(*r, rect) || i == ctx->damage_list.cap - 1) {
+      *r = union_rects(*r, rect);
+      return;
+    }
+  }
+  push(ctx->damage_list, rect);
+}
+
+
+static void update_damage(mu_Context *ctx) {
+  int i;
+  ctx->damage_list.idx = 0;
+  /* damage root containers whose segment, zindex or area changed, or which
+  ** were not drawn last frame */
+  for (i = 0; i < ctx->root_list.idx; i++) {
+    mu_Container *cnt = ctx->root_list.items[i];
+    mu_Id h = hash_segment(cnt);
+    if (cnt->last_draw_frame != ctx->frame - 1 || cnt->last_draw_hash != h) {
+      add_damage(ctx, cnt->draw_rect);
+      if (cnt->last_draw_frame == ctx->frame - 1) {
+        add_damage(ctx, cnt->last_draw_rect);
+      }
+    }
+    cnt->last_draw_rect = cnt->draw_rect;
+    cnt->last_draw_hash = h;
+    cnt->last_draw_frame = ctx->frame;
+  }
+  /* damage the last area of root containers drawn last frame but not this */
+  for (i = 0; i < ctx->last_root_list.idx; i++) {
+    mu_Container *cnt = ctx->last_root_list.items[i];
+    if (cnt->last_draw_frame != ctx->frame) {
+      add_damage(ctx, cnt->last_draw_rect);
+    }
+  }
+  memcpy(ctx->last_root_list.items, ctx->root_list.items,
+    ctx->root_list.idx * sizeof(mu_Container*));
+  ctx->last_root_list.idx = ctx->root_list.idx;
+}
+
+
+int mu_end(mu_Context *ctx) {
   int i, n;
+  /* input was handled this frame, so the next one may look different; any
+  ** events still queued are applied by the next frames */
+  if (ctx->mouse_pressed || ctx->key_pressed || ctx->input_text[0] ||
+      ctx->scroll_delta.x || ctx->scroll_delta.y ||
+      ctx->hover_root != ctx->next_hover_root ||
+      ctx->event_queue.count > ctx->event_queue.applied
+  ) {
+    mu_request_frame(ctx, 0);
+  }
+
   /* check stacks */
   expect(ctx->container_stack.idx == 0);
   expect(ctx->clip_stack.idx      == 0);
@@ -168,7 +680,10 @@ void mu_end(mu_Context *ctx) {
   }
 
   /* unset focus if focus id was not touched this frame */
-  if (!ctx->updated_focus) { ctx->focus = 0; }
+  if (!ctx->updated_focus && ctx->focus) {
+    ctx->focus = 0;
+    mu_request_frame(ctx, 0);
+  }
   ctx->updated_focus = 0;
 
   /* bring hover root to front if mouse was pressed */
@@ -179,6 +694,9 @@ void mu_end(mu_Context *ctx) {
     mu_bring_to_front(ctx, ctx->next_hover_root);
   }
 
+  /* a focused control is being edited or dragged */
+  if (ctx->focus) { ctx->frame_flags |= MU_FRAME_ACTIVE; }
+
   /* reset input state */
   ctx->key_pressed = 0;
   ctx->input_text[0] = '\0';
@@ -187,8 +705,8 @@ void mu_end(mu_Context *ctx) {
   ctx->last_mouse_pos = ctx->mouse_pos;
 
   /* sort root containers by zindex */
+  sort_roots(ctx);
   n = ctx->root_list.idx;
-  qsort(ctx->root_list.items, n, sizeof(mu_Container*), compare_zindex);
 
   /* set root container jump commands */
   for (i = 0; i < n; i++) {
@@ -196,7 +714,7 @@ void mu_end(mu_Context *ctx) {
     /* if this is the first container then make the first command jump to it.
     ** otherwise set the previous container's tail to jump to this one */
     if (i == 0) {
-      mu_Command *cmd = (mu_Command*) ctx->command_list.items;
+      mu_Command *cmd = (mu_Command*) (ctx->command_list.head + 1);
       cmd->jump.dst = (char*) cnt->head + sizeof(mu_JumpCommand);
     } else {
       mu_Container *prev = ctx->root_list.items[i - 1];
@@ -207,6 +725,140 @@ void mu_end(mu_Context *ctx) {
       cnt->tail->jump.dst = ctx->command_list.items + ctx->command_list.idx;
     }
   }
+
+  /* find the screen areas which changed since the last frame. a changed
+  ** frame is followed by another, as state set while building it may only
+  ** show in the next */
+  update_damage(ctx);
+  track(ctx->stats.root_count = n);
+  if (ctx->damage_list.idx) {
+    ctx->frame_flags |= MU_FRAME_CHANGED;
+    mu_request_frame(ctx, 0);
+  }
+  return ctx->frame_flags;
+}
+
+
+void mu_request_frame(mu_Context *ctx, int ms) {
+  ms = mu_max(ms, 0);
+  if (ctx->frame_delay < 0 || ms < ctx->frame_delay) { ctx->frame_delay = ms; }
+}
+
+
+void mu_fork(mu_Context *ctx, mu_Context *sub) {
+  /* begin a frame on `sub` with the style, callbacks and input of `ctx`, so
+  ** that windows can be built with it on another thread */
+  sub->style = ctx->style;
+  sub->text_width = ctx->text_width;
+  sub->text_height = ctx->text_height;
+  sub->draw_frame = ctx->draw_frame;
+  sub->hover = sub->fork_hover = ctx->hover;
+  sub->focus = sub->fork_focus = ctx->focus;
+  sub->last_zindex = sub->fork_zindex = ctx->last_zindex;
+  sub->updated_focus = 0;
+  sub->frame = ctx->frame;
+  sub->hover_root = ctx->hover_root;
+  sub->next_hover_root = NULL;
+  sub->scroll_target = NULL;
+  sub->mouse_pos = ctx->mouse_pos;
+  sub->last_mouse_pos = ctx->last_mouse_pos;
+  sub->mouse_delta = ctx->mouse_delta;
+  sub->scroll_delta = ctx->scroll_delta;
+  sub->mouse_down = ctx->mouse_down;
+  sub->mouse_pressed = ctx->mouse_pressed;
+  sub->key_down = ctx->key_down;
+  sub->key_pressed = ctx->key_pressed;
+  memcpy(sub->input_text, ctx->input_text, sizeof(ctx->input_text));
+  /* the sub-context reads the parent's events of the frame; it never owns
+  ** them, nor queues its own */
+  sub->event_queue = ctx->event_queue;
+  sub->event_queue.count = ctx->event_queue.applied;
+  sub->event_queue.grown = 0;
+  reset_commands(sub);
+  sub->root_list.idx = 0;
+  sub->frame_flags = 0;
+  sub->frame_delay = -1;
+#ifdef MU_STATS
+  {
+    mu_RootStats *roots = sub->stats.roots;
+    memset(&sub->stats, 0, sizeof(sub->stats));
+    sub->stats.roots = roots;
+    sub->stats.current_root = -1;
+  }
+#endif
+}
+
+
+static void join_id(mu_Id *dst, mu_Id src, mu_Id forked) {
+  /* a newly set id wins; an id cleared by the sub-context is only cleared if
+  ** nothing else changed it since the fork */
+  if (src == forked) { return; }
+  if (src || *dst == forked) { *dst = src; }
+}
+
+
+void mu_join(mu_Context *ctx, mu_Context *sub) {
+  int i, offset = ctx->last_zindex - sub->fork_zindex;
+  expect(sub->container_stack.idx == 0);
+  expect(sub->clip_stack.idx      == 0);
+  expect(sub->id_stack.idx        == 0);
+  expect(sub->layout_stack.idx    == 0);
+
+  /* move zindexes given out by the sub-context since the fork above those of
+  ** `ctx`, keeping their order, so that the result only depends on the order
+  ** of the joins */
+  for (i = 0; i < sub->container_pool.len; i++) {
+    mu_Container *cnt = &sub->containers[i];
+    if (cnt->zindex > sub->fork_zindex) { cnt->zindex += offset; }
+  }
+  ctx->last_zindex += sub->last_zindex - sub->fork_zindex;
+
+  /* merge interaction state */
+  join_id(&ctx->hover, sub->hover, sub->fork_hover);
+  if (sub->focus != sub->fork_focus || sub->updated_focus) {
+    join_id(&ctx->focus, sub->focus, sub->fork_focus);
+    if (ctx->focus == sub->focus) { ctx->updated_focus |= sub->updated_focus; }
+  }
+  if (sub->next_hover_root && (!ctx->next_hover_root ||
+      sub->next_hover_root->zindex > ctx->next_hover_root->zindex)
+  ) {
+    ctx->next_hover_root = sub->next_hover_root;
+  }
+  if (sub->scroll_target) { ctx->scroll_target = sub->scroll_target; }
+  ctx->frame_flags |= sub->frame_flags;
+  if (sub->frame_delay >= 0) { mu_request_frame(ctx, sub->frame_delay); }
+
+  /* add the sub-context's root containers; their command segments stay in
+  ** its command list and are linked in by `mu_end()`, so the sub-context must
+  ** not be forked again until the commands of `ctx` have been used. if `ctx`
+  ** has no commands yet, a jump is pushed for `mu_end()` to point at the
+  ** first root container */
+  if (sub->root_list.idx && ctx->command_list.total + ctx->command_list.idx == 0) {
+    mu_push_command(ctx, MU_COMMAND_JUMP, sizeof(mu_JumpCommand));
+  }
+  for (i = 0; i < sub->root_list.idx; i++) {
+    push(ctx->root_list, sub->root_list.items[i]);
+#ifdef MU_STATS
+    {
+      mu_RootStats *rs = &ctx->stats.roots[ctx->root_list.idx - 1];
+      *rs = sub->stats.roots[i];
+      if (rs->parent >= 0) { rs->parent += ctx->root_list.idx - 1 - i; }
+    }
+#endif
+  }
+
+#ifdef MU_STATS
+  ctx->stats.commands += sub->stats.commands;
+  ctx->stats.bytes += sub->stats.bytes;
+  ctx->stats.clip_pushes += sub->stats.clip_pushes;
+  ctx->stats.text_width_calls += sub->stats.text_width_calls;
+  ctx->stats.text_height_calls += sub->stats.text_height_calls;
+  ctx->stats.pool_lookups += sub->stats.pool_lookups;
+  ctx->stats.pool_hits += sub->stats.pool_hits;
+  ctx->stats.pool_evictions += sub->stats.pool_evictions;
+  ctx->stats.text_lines += sub->stats.text_lines;
+  ctx->stats.text_lines_drawn += sub->stats.text_lines_drawn;
+#endif
 }
 
 
@@ -216,21 +868,48 @@ void mu_set_focus(mu_Context *ctx, mu_Id id) {
 }
 
 
-/* 32bit fnv-1a hash */
-#define HASH_INITIAL 2166136261
+mu_Id mu_get_id(mu_Context *ctx, const void *data, int size) {
+  int idx = ctx->id_stack.idx;
+  mu_Id res = (idx > 0) ? ctx->id_stack.items[idx - 1] : HASH_INITIAL;
+  hash(&res, data, size);
+  ctx->last_id = res;
+  return res;
+}
+
 
-static void hash(mu_Id *hash, const void *data, int size) {
-  const unsigned char *p = data;
-  while (size--) {
-    *hash = (*hash ^ *p++) * 16777619;
+mu_Id mu_get_id_ptr(mu_Context *ctx, const void *ptr) {
+  /* gives the same id as `mu_get_id(ctx, &ptr, sizeof(ptr))`, hashing the
+  ** pointer's words directly */
+  int idx = ctx->id_stack.idx;
+  mu_Id res = (idx > 0) ? ctx->id_stack.items[idx - 1] : HASH_INITIAL;
+  mu_Id w[(sizeof(ptr) + sizeof(mu_Id) - 1) / sizeof(mu_Id)];
+  int i;
+  if (sizeof(ptr) % sizeof(mu_Id)) { return mu_get_id(ctx, &ptr, sizeof(ptr)); }
+  memcpy(w, &ptr, sizeof(ptr));
+  for (i = 0; i < (int) (sizeof(w) / sizeof(mu_Id)); i++) {
+    res = hash_step(res, w[i]);
   }
+  ctx->last_id = res;
+  return res;
 }
 
 
-mu_Id mu_get_id(mu_Context *ctx, const void *data, int size) {
+/* ids of a container's own controls (title bar, scrollbars...) are derived
+** from its id with a single hash step rather than by hashing a name. the tags
+** are '!' prefixed four character codes, like the names they replace, so they
+** don't collide with the small integers which are often used as keys */
+enum {
+  ID_TITLE       = 0x21746974, /* "!tit" */
+  ID_CLOSE       = 0x21636c6f, /* "!clo" */
+  ID_RESIZE      = 0x21726573, /* "!res" */
+  ID_SCROLLBAR_x = 0x21736378, /* "!scx" */
+  ID_SCROLLBAR_y = 0x21736379  /* "!scy" */
+};
+
+static mu_Id get_child_id(mu_Context *ctx, int tag) {
   int idx = ctx->id_stack.idx;
   mu_Id res = (idx > 0) ? ctx->id_stack.items[idx - 1] : HASH_INITIAL;
-  hash(&res, data, size);
+  res = hash_step(res, (mu_Id) tag);
   ctx->last_id = res;
   return res;
 }
@@ -249,6 +928,7 @@ void mu_pop_id(mu_Context *ctx) {
 void mu_push_clip_rect(mu_Context *ctx, mu_Rect rect) {
   mu_Rect last = mu_get_clip_rect(ctx);
   push(ctx->clip_stack, intersect_rects(rect, last));
+  track(ctx->stats.clip_pushes++);
 }
 
 
@@ -308,20 +988,29 @@ mu_Container* mu_get_current_container(mu_Context *ctx) {
 
 
 static mu_Container* get_container(mu_Context *ctx, mu_Id id, int opt) {
-  mu_Container *cnt;
+  mu_Container *cnt, last;
   /* try to get existing container from pool */
-  int idx = mu_pool_get(ctx, ctx->container_pool, MU_CONTAINERPOOL_SIZE, id);
+  int idx = mu_pool_get(ctx, &ctx->container_pool, id);
   if (idx >= 0) {
     if (ctx->containers[idx].open || ~opt & MU_OPT_CLOSED) {
-      mu_pool_update(ctx, ctx->container_pool, idx);
+      mu_pool_update(ctx, &ctx->container_pool, idx);
     }
     return &ctx->containers[idx];
   }
   if (opt & MU_OPT_CLOSED) { return NULL; }
-  /* container not found in pool: init new container */
-  idx = mu_pool_init(ctx, ctx->container_pool, MU_CONTAINERPOOL_SIZE, id);
+  /* container not found in pool: init new container. the last drawn state is
+  ** kept so the area of an evicted root container is still damaged */
+  idx = mu_pool_init(ctx, &ctx->container_pool, id);
   cnt = &ctx->containers[idx];
+  last = *cnt;
+  if (last.cache) {
+    if (last.cache->items) { ctx->alloc(ctx, last.cache->items, 0); }
+    ctx->alloc(ctx, last.cache, 0);
+  }
   memset(cnt, 0, sizeof(*cnt));
+  cnt->last_draw_rect = last.last_draw_rect;
+  cnt->last_draw_hash = last.last_draw_hash;
+  cnt->last_draw_frame = last.last_draw_frame;
   cnt->open = 1;
   mu_bring_to_front(ctx, cnt);
   return cnt;
@@ -343,33 +1032,130 @@ void mu_bring_to_front(mu_Context *ctx, mu_Container *cnt) {
 ** pool
 **============================================================================*/
 
-int mu_pool_init(mu_Context *ctx, mu_PoolItem *items, int len, mu_Id id) {
-  int i, n = -1, f = ctx->frame;
-  for (i = 0; i < len; i++) {
-    if (items[i].last_update < f) {
-      f = items[i].last_update;
-      n = i;
-    }
+/* the pool keeps an open addressing hash table from id to item index for O(1)
+** lookups, and a doubly linked list of its items ordered by `last_update` so
+** the least recently updated item can be evicted in O(1) */
+
+static int pool_slot(mu_Pool *pool, mu_Id id) {
+  return mix_id(id) % MU_POOL_TABLESIZE(pool->len);
+}
+
+
+static void pool_unlink(mu_Pool *pool, int idx) {
+  mu_PoolItem *item = &pool->items[idx];
+  if (item->prev >= 0) { pool->items[item->prev].next = item->next; }
+                  else { pool->head = item->next; }
+  if (item->next >= 0) { pool->items[item->next].prev = item->prev; }
+                  else { pool->tail = item->prev; }
+}
+
+
+static void pool_link_tail(mu_Pool *pool, int idx) {
+  mu_PoolItem *item = &pool->items[idx];
+  item->prev = pool->tail;
+  item->next = -1;
+  if (pool->tail >= 0) { pool->items[pool->tail].next = idx; }
+                  else { pool->head = idx; }
+  pool->tail = idx;
+}
+
+
+static void pool_link_head(mu_Pool *pool, int idx) {
+  mu_PoolItem *item = &pool->items[idx];
+  item->prev = -1;
+  item->next = pool->head;
+  if (pool->head >= 0) { pool->items[pool->head].prev = idx; }
+                  else { pool->tail = idx; }
+  pool->head = idx;
+}
+
+
+static void pool_table_insert(mu_Pool *pool, int idx) {
+  int n = MU_POOL_TABLESIZE(pool->len);
+  int i = pool_slot(pool, pool->items[idx].id);
+  while (pool->table[i] >= 0) { i = (i + 1) % n; }
+  pool->table[i] = idx;
+}
+
+
+static void pool_table_remove(mu_Pool *pool, int idx) {
+  int n = MU_POOL_TABLESIZE(pool->len);
+  int i = pool_slot(pool, pool->items[idx].id), j, k;
+  /* find the item's slot; items which are not in the table are ignored */
+  while (pool->table[i] != idx) {
+    if (pool->table[i] < 0) { return; }
+    i = (i + 1) % n;
+  }
+  /* remove it and shift back any following entries of its probe sequence so
+  ** no tombstones are needed */
+  pool->table[i] = -1;
+  for (j = (i + 1) % n; pool->table[j] >= 0; j = (j + 1) % n) {
+    k = pool_slot(pool, pool->items[pool->table[j]].id);
+    if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) { continue; }
+    pool->table[i] = pool->table[j];
+    pool->table[j] = -1;
+    i = j;
   }
-  expect(n > -1);
-  items[n].id = id;
-  mu_pool_update(ctx, items, n);
-  return n;
 }
 
 
-int mu_pool_get(mu_Context *ctx, mu_PoolItem *items, int len, mu_Id id) {
+void mu_pool_setup(mu_Pool *pool, mu_PoolItem *items, int *table, int len) {
   int i;
+  pool->items = items;
+  pool->table = table;
+  pool->len = len;
+  pool->head = pool->tail = -1;
+  memset(items, 0, len * sizeof(*items));
+  for (i = 0; i < len; i++) { pool_link_tail(pool, i); }
+  for (i = 0; i < MU_POOL_TABLESIZE(len); i++) { table[i] = -1; }
+}
+
+
+int mu_pool_init(mu_Context *ctx, mu_Pool *pool, mu_Id id) {
+  int n = pool->head;
+  expect(n > -1 && pool->items[n].last_update < ctx->frame);
+  track(ctx->stats.pool_evictions += pool->items[n].id != 0);
+  pool_table_remove(pool, n);
+  pool->items[n].id = id;
+  pool_table_insert(pool, n);
+  mu_pool_update(ctx, pool, n);
+  return n;
+}
+
+
+int mu_pool_get(mu_Context *ctx, mu_Pool *pool, mu_Id id) {
+  int n = MU_POOL_TABLESIZE(pool->len);
+  int i = pool_slot(pool, id);
   unused(ctx);
-  for (i = 0; i < len; i++) {
-    if (items[i].id == id) { return i; }
+  track(ctx->stats.pool_lookups++);
+  while (pool->table[i] >= 0) {
+    if (pool->items[pool->table[i]].id == id) {
+      track(ctx->stats.pool_hits++);
+      return pool->table[i];
+    }
+    i = (i + 1) % n;
   }
   return -1;
 }
 
 
-void mu_pool_update(mu_Context *ctx, mu_PoolItem *items, int idx) {
-  items[idx].last_update = ctx->frame;
+void mu_pool_update(mu_Context *ctx, mu_Pool *pool, int idx) {
+  pool->items[idx].last_update = ctx->frame;
+  if (pool->tail != idx) {
+    pool_unlink(pool, idx);
+    pool_link_tail(pool, idx);
+  }
+}
+
+
+void mu_pool_remove(mu_Context *ctx, mu_Pool *pool, int idx) {
+  unused(ctx);
+  pool_table_remove(pool, idx);
+  pool->items[idx].id = 0;
+  pool->items[idx].last_update = 0;
+  /* move to the front so the item is the first to be reused */
+  pool_unlink(pool, idx);
+  pool_link_head(pool, idx);
 }
 
 
@@ -377,46 +1163,114 @@ void mu_pool_update(mu_Context *ctx, mu_PoolItem *items, int idx) {
 ** input handlers
 **============================================================================*/
 
+static mu_Event* push_event(mu_Context *ctx, int type) {
+  mu_EventQueue *q = &ctx->event_queue;
+  mu_Event *e;
+  int i;
+  if (q->count == q->cap) {
+    if (ctx->alloc) {
+      /* grow the queue, moving the events to the start of the new one */
+      int cap = mu_max(q->cap * 2, MU_EVENTQUEUE_SIZE);
+      mu_Event *items = ctx->alloc(ctx, NULL, cap * sizeof(mu_Event));
+      expect(items);
+      for (i = 0; i < q->count; i++) { items[i] = *event_at(q, i); }
+      if (q->grown) { ctx->alloc(ctx, q->items, 0); }
+      q->items = items;
+      q->cap = cap;
+      q->first = 0;
+      q->grown = 1;
+    } else {
+      /* without `alloc` the oldest event is folded into the input state as
+      ** it arrives, as if it had been applied early */
+      if (q->applied > 0) {
+        q->applied--;
+      } else {
+        apply_event(ctx, event_at(q, 0));
+      }
+      q->first = (q->first + 1) % q->cap;
+      q->count--;
+    }
+  }
+  e = event_at(q, q->count++);
+  memset(e, 0, sizeof(*e));
+  e->type = type;
+  return e;
+}
+
+
+/* returns the last event if it is still queued and of the given type */
+static mu_Event* pending_event(mu_Context *ctx, int type) {
+  mu_EventQueue *q = &ctx->event_queue;
+  mu_Event *e;
+  if (q->count == q->applied) { return NULL; }
+  e = event_at(q, q->count - 1);
+  return e->type == type ? e : NULL;
+}
+
+
 void mu_input_mousemove(mu_Context *ctx, int x, int y) {
-  ctx->mouse_pos = mu_vec2(x, y);
+  /* consecutive moves are merged */
+  mu_Event *e = pending_event(ctx, MU_EVENT_MOUSEMOVE);
+  if (!e) { e = push_event(ctx, MU_EVENT_MOUSEMOVE); }
+  e->pos = mu_vec2(x, y);
 }
 
 
 void mu_input_mousedown(mu_Context *ctx, int x, int y, int btn) {
-  mu_input_mousemove(ctx, x, y);
-  ctx->mouse_down |= btn;
-  ctx->mouse_pressed |= btn;
+  mu_Event *e = push_event(ctx, MU_EVENT_MOUSEDOWN);
+  e->pos = mu_vec2(x, y);
+  e->value = btn;
 }
 
 
 void mu_input_mouseup(mu_Context *ctx, int x, int y, int btn) {
-  mu_input_mousemove(ctx, x, y);
-  ctx->mouse_down &= ~btn;
+  mu_Event *e = push_event(ctx, MU_EVENT_MOUSEUP);
+  e->pos = mu_vec2(x, y);
+  e->value = btn;
 }
 
 
 void mu_input_scroll(mu_Context *ctx, int x, int y) {
-  ctx->scroll_delta.x += x;
-  ctx->scroll_delta.y += y;
+  /* consecutive scrolls are summed */
+  mu_Event *e = pending_event(ctx, MU_EVENT_SCROLL);
+  if (!e) { e = push_event(ctx, MU_EVENT_SCROLL); }
+  e->pos.x += x;
+  e->pos.y += y;
 }
 
 
 void mu_input_keydown(mu_Context *ctx, int key) {
-  ctx->key_pressed |= key;
-  ctx->key_down |= key;
+  push_event(ctx, MU_EVENT_KEYDOWN)->value = key;
 }
 
 
 void mu_input_keyup(mu_Context *ctx, int key) {
-  ctx->key_down &= ~key;
+  push_event(ctx, MU_EVENT_KEYUP)->value = key;
 }
 
 
 void mu_input_text(mu_Context *ctx, const char *text) {
-  int len = strlen(ctx->input_text);
-  int size = strlen(text) + 1;
-  expect(len + size <= (int) sizeof(ctx->input_text));
-  memcpy(ctx->input_text + len, text, size);
+  int len = strlen(text);
+  /* split into events on UTF-8 character boundaries */
+  while (len > 0) {
+    mu_Event *e = push_event(ctx, MU_EVENT_TEXT);
+    int n = mu_min(len, (int) sizeof(e->text) - 1);
+    while (n < len && n > 0 && (text[n] & 0xc0) == 0x80) { n--; }
+    if (n == 0) { n = mu_min(len, (int) sizeof(e->text) - 1); }
+    memcpy(e->text, text, n);
+    text += n;
+    len -= n;
+  }
+}
+
+
+int mu_next_event(mu_Context *ctx, mu_Event **event) {
+  mu_EventQueue *q = &ctx->event_queue;
+  int i = 0;
+  if (*event) { i = ((*event - q->items) - q->first + q->cap) % q->cap + 1; }
+  if (i >= q->applied) { return 0; }
+  *event = event_at(q, i);
+  return 1;
 }
 
 
@@ -424,12 +1278,54 @@ void mu_input_text(mu_Context *ctx, const char *text) {
 ** commandlist
 **============================================================================*/
 
+static void next_command_chunk(mu_Context *ctx, int size) {
+  mu_CommandList *cl = &ctx->command_list;
+  mu_CommandChunk *chunk = cl->chunk->next;
+  mu_Command *jump = (mu_Command*) (cl->items + cl->idx);
+  size += sizeof(mu_JumpCommand);
+  /* reuse the next chunk kept from an earlier frame if it is big enough,
+  ** otherwise allocate a new one and insert it in front of it */
+  if (!chunk || chunk->size < size) {
+    int n = mu_max(MU_COMMANDCHUNK_SIZE, size);
+    expect(ctx->alloc);
+    chunk = ctx->alloc(ctx, NULL, sizeof(mu_CommandChunk) + n);
+    expect(chunk);
+    chunk->size = n;
+    chunk->next = cl->chunk->next;
+    cl->chunk->next = chunk;
+  }
+  /* end the current chunk with a jump to the new one */
+  jump->base.type = MU_COMMAND_JUMP;
+  jump->base.size = sizeof(mu_JumpCommand);
+  jump->jump.dst = chunk + 1;
+  cl->total += cl->idx + sizeof(mu_JumpCommand);
+  cl->chunk = chunk;
+  cl->items = (char*) (chunk + 1);
+  cl->size = chunk->size;
+  cl->idx = 0;
+}
+
+
 mu_Command* mu_push_command(mu_Context *ctx, int type, int size) {
-  mu_Command *cmd = (mu_Command*) (ctx->command_list.items + ctx->command_list.idx);
-  expect(ctx->command_list.idx + size < MU_COMMANDLIST_SIZE);
+  mu_Command *cmd;
+  /* always leave room for the jump which links to the next chunk */
+  if (ctx->command_list.idx + size + (int) sizeof(mu_JumpCommand) >
+      ctx->command_list.size
+  ) {
+    next_command_chunk(ctx, size);
+  }
+  cmd = (mu_Command*) (ctx->command_list.items + ctx->command_list.idx);
   cmd->base.type = type;
   cmd->base.size = size;
   ctx->command_list.idx += size;
+#ifdef MU_STATS
+  ctx->stats.commands++;
+  ctx->stats.bytes += size;
+  if (ctx->stats.current_root >= 0) {
+    ctx->stats.roots[ctx->stats.current_root].commands++;
+    ctx->stats.roots[ctx->stats.current_root].bytes += size;
+  }
+#endif
   return cmd;
 }
 
@@ -438,7 +1334,7 @@ int mu_next_command(mu_Context *ctx, mu_Command **cmd) {
   if (*cmd) {
     *cmd = (mu_Command*) (((char*) *cmd) + (*cmd)->base.size);
   } else {
-    *cmd = (mu_Command*) ctx->command_list.items;
+    *cmd = (mu_Command*) (ctx->command_list.head + 1);
   }
   while ((char*) *cmd != ctx->command_list.items + ctx->command_list.idx) {
     if ((*cmd)->type != MU_COMMAND_JUMP) { return 1; }
@@ -460,6 +1356,31 @@ void mu_set_clip(mu_Context *ctx, mu_Rect rect) {
   mu_Command *cmd;
   cmd = mu_push_command(ctx, MU_COMMAND_CLIP, sizeof(mu_ClipCommand));
   cmd->clip.rect = rect;
+  ctx->command_clip = rect;
+}
+
+
+static void clip_item(mu_Context *ctx, mu_Rect rect) {
+  /* the last emitted clip rect is kept while it clips the item the same way as
+  ** the current clip rect would; otherwise the outermost clip rect on the stack
+  ** which does is emitted, so it can be shared by the items which follow.
+  ** resets are thereby deferred until an item actually needs one */
+  mu_Rect want = intersect_rects(rect, mu_get_clip_rect(ctx));
+  int i = ctx->clip_stack.idx - 1;
+  if (rects_equal(intersect_rects(rect, ctx->command_clip), want)) { return; }
+  while (i > 0) {
+    mu_Rect r = intersect_rects(rect, ctx->clip_stack.items[i - 1]);
+    if (!rects_equal(r, want)) { break; }
+    i--;
+  }
+  mu_set_clip(ctx, ctx->clip_stack.items[i]);
+}
+
+
+static void reset_clip(mu_Context *ctx) {
+  if (!rects_equal(ctx->command_clip, unclipped_rect)) {
+    mu_set_clip(ctx, unclipped_rect);
+  }
 }
 
 
@@ -467,6 +1388,8 @@ void mu_draw_rect(mu_Context *ctx, mu_Rect rect, mu_Color color) {
   mu_Command *cmd;
   rect = intersect_rects(rect, mu_get_clip_rect(ctx));
   if (rect.w > 0 && rect.h > 0) {
+    /* already clipped, but a deferred clip command must not cut it further */
+    clip_item(ctx, rect);
     cmd = mu_push_command(ctx, MU_COMMAND_RECT, sizeof(mu_RectCommand));
     cmd->rect.rect = rect;
     cmd->rect.color = color;
@@ -482,15 +1405,13 @@ void mu_draw_box(mu_Context *ctx, mu_Rect rect, mu_Color color) {
 }
 
 
-void mu_draw_text(mu_Context *ctx, mu_Font font, const char *str, int len,
-  mu_Vec2 pos, mu_Color color)
+static void draw_text(mu_Context *ctx, mu_Font font, const char *str, int len,
+  mu_Vec2 pos, mu_Color color, int width)
 {
   mu_Command *cmd;
-  mu_Rect rect = mu_rect(
-    pos.x, pos.y, ctx->text_width(font, str, len), ctx->text_height(font));
-  int clipped = mu_check_clip(ctx, rect);
-  if (clipped == MU_CLIP_ALL ) { return; }
-  if (clipped == MU_CLIP_PART) { mu_set_clip(ctx, mu_get_clip_rect(ctx)); }
+  mu_Rect rect = mu_rect(pos.x, pos.y, width, text_height(ctx, font));
+  if (mu_check_clip(ctx, rect) == MU_CLIP_ALL) { return; }
+  clip_item(ctx, rect);
   /* add command */
   if (len < 0) { len = strlen(str); }
   cmd = mu_push_command(ctx, MU_COMMAND_TEXT, sizeof(mu_TextCommand) + len);
@@ -499,24 +1420,210 @@ void mu_draw_text(mu_Context *ctx, mu_Font font, const char *str, int len,
   cmd->text.pos = pos;
   cmd->text.color = color;
   cmd->text.font = font;
-  /* reset clipping if it was set */
-  if (clipped) { mu_set_clip(ctx, unclipped_rect); }
+}
+
+
+void mu_draw_text(mu_Context *ctx, mu_Font font, const char *str, int len,
+  mu_Vec2 pos, mu_Color color)
+{
+  draw_text(ctx, font, str, len, pos, color, text_width(ctx, font, str, len));
 }
 
 
 void mu_draw_icon(mu_Context *ctx, int id, mu_Rect rect, mu_Color color) {
   mu_Command *cmd;
-  /* do clip command if the rect isn't fully contained within the cliprect */
-  int clipped = mu_check_clip(ctx, rect);
-  if (clipped == MU_CLIP_ALL ) { return; }
-  if (clipped == MU_CLIP_PART) { mu_set_clip(ctx, mu_get_clip_rect(ctx)); }
+  /* do clip command if the rect isn't clipped the same way by the last one */
+  if (mu_check_clip(ctx, rect) == MU_CLIP_ALL) { return; }
+  clip_item(ctx, rect);
   /* do icon command */
   cmd = mu_push_command(ctx, MU_COMMAND_ICON, sizeof(mu_IconCommand));
   cmd->icon.id = id;
   cmd->icon.rect = rect;
   cmd->icon.color = color;
-  /* reset clipping if it was set */
-  if (clipped) { mu_set_clip(ctx, unclipped_rect); }
+}
+
+
+/*============================================================================
+** draw list
+**============================================================================*/
+
+/* quads are gathered in blocks holding one array per field, so clipping can
+** run as a flat loop over each block that the compiler can vectorize */
+#define QUAD_BLOCK_SIZE 64
+
+struct mu_QuadBlock {
+  float x0[QUAD_BLOCK_SIZE], y0[QUAD_BLOCK_SIZE]; /* destination rect */
+  float x1[QUAD_BLOCK_SIZE], y1[QUAD_BLOCK_SIZE];
+  float cx0[QUAD_BLOCK_SIZE], cy0[QUAD_BLOCK_SIZE]; /* clip rect */
+  float cx1[QUAD_BLOCK_SIZE], cy1[QUAD_BLOCK_SIZE];
+  float u0[QUAD_BLOCK_SIZE], v0[QUAD_BLOCK_SIZE]; /* source rect */
+  float u1[QUAD_BLOCK_SIZE], v1[QUAD_BLOCK_SIZE];
+  mu_Color color[QUAD_BLOCK_SIZE];
+};
+
+
+static void drawlist_reserve(mu_Context *ctx, mu_DrawList *dl, int quads) {
+  int i, n, blocks;
+  if (quads <= dl->quad_cap) { return; }
+  n = mu_max(quads, mu_max(dl->quad_cap * 2, 256));
+  blocks = (n + QUAD_BLOCK_SIZE - 1) / QUAD_BLOCK_SIZE;
+  expect(ctx->alloc);
+  dl->vertices = ctx->alloc(ctx, dl->vertices, n * 4 * sizeof(mu_Vertex));
+  dl->indices = ctx->alloc(ctx, dl->indices, n * 6 * sizeof(unsigned));
+  dl->quad_blocks = ctx->alloc(ctx, dl->quad_blocks,
+    blocks * sizeof(mu_QuadBlock));
+  expect(dl->vertices && dl->indices && dl->quad_blocks);
+  /* the index pattern never changes, so it is only written when growing */
+  for (i = dl->quad_cap; i < n; i++) {
+    unsigned *idx = dl->indices + i * 6, v = i * 4;
+    idx[0] = v + 0; idx[1] = v + 1; idx[2] = v + 2;
+    idx[3] = v + 2; idx[4] = v + 3; idx[5] = v + 1;
+  }
+  dl->quad_cap = n;
+}
+
+
+static void drawlist_push(mu_DrawList *dl, int n, mu_Rect dst, mu_Rect src,
+  mu_Color color, mu_Rect clip)
+{
+  mu_QuadBlock *q = dl->quad_blocks + n / QUAD_BLOCK_SIZE;
+  int i = n % QUAD_BLOCK_SIZE;
+  q->x0[i] = dst.x;            q->y0[i] = dst.y;
+  q->x1[i] = dst.x + dst.w;    q->y1[i] = dst.y + dst.h;
+  q->cx0[i] = clip.x;          q->cy0[i] = clip.y;
+  q->cx1[i] = clip.x + clip.w; q->cy1[i] = clip.y + clip.h;
+  q->u0[i] = src.x;            q->v0[i] = src.y;
+  q->u1[i] = src.x + src.w;    q->v1[i] = src.y + src.h;
+  q->color[i] = color;
+}
+
+
+static void drawlist_clip(mu_DrawList *dl, int n) {
+  float aw = dl->atlas_width, ah = dl->atlas_height;
+  int i, j;
+  /* clip each quad and map the clipped rect back into its source rect, in
+  ** place. quads clipped away are left for the emit loop to skip; their size
+  ** is clamped so the divisions stay finite */
+  for (i = 0; i < n; i += QUAD_BLOCK_SIZE) {
+    mu_QuadBlock *q = dl->quad_blocks + i / QUAD_BLOCK_SIZE;
+    int m = mu_min(n - i, QUAD_BLOCK_SIZE);
+    for (j = 0; j < m; j++) {
+      float w = q->x1[j] - q->x0[j], h = q->y1[j] - q->y0[j], su, sv;
+      float l = mu_max(q->x0[j], q->cx0[j]), t = mu_max(q->y0[j], q->cy0[j]);
+      float r = mu_min(q->x1[j], q->cx1[j]), b = mu_min(q->y1[j], q->cy1[j]);
+      w = mu_max(w, 1);
+      h = mu_max(h, 1);
+      su = (q->u1[j] - q->u0[j]) / w / aw;
+      sv = (q->v1[j] - q->v0[j]) / h / ah;
+      q->u0[j] = q->u0[j] / aw + (l - q->x0[j]) * su;
+      q->v0[j] = q->v0[j] / ah + (t - q->y0[j]) * sv;
+      q->u1[j] = q->u0[j] + (r - l) * su;
+      q->v1[j] = q->v0[j] + (b - t) * sv;
+      q->x0[j] = l; q->y0[j] = t;
+      q->x1[j] = r; q->y1[j] = b;
+    }
+  }
+}
+
+
+static void drawlist_emit(mu_DrawList *dl, int n) {
+  int i, j, out = 0;
+  /* every quad is written, but the output only advances past non-empty ones,
+  ** so empty quads are dropped without a branch */
+  for (i = 0; i < n; i += QUAD_BLOCK_SIZE) {
+    mu_QuadBlock *q = dl->quad_blocks + i / QUAD_BLOCK_SIZE;
+    int m = mu_min(n - i, QUAD_BLOCK_SIZE);
+    for (j = 0; j < m; j++) {
+      mu_Vertex *v = dl->vertices + out * 4;
+      float x0 = q->x0[j], y0 = q->y0[j], x1 = q->x1[j], y1 = q->y1[j];
+      float u0 = q->u0[j], v0 = q->v0[j], u1 = q->u1[j], v1 = q->v1[j];
+      v[0].x = x0; v[0].y = y0; v[0].u = u0; v[0].v = v0;
+      v[1].x = x1; v[1].y = y0; v[1].u = u1; v[1].v = v0;
+      v[2].x = x0; v[2].y = y1; v[2].u = u0; v[2].v = v1;
+      v[3].x = x1; v[3].y = y1; v[3].u = u1; v[3].v = v1;
+      v[0].color = v[1].color = v[2].color = v[3].color = q->color[j];
+      out += (x1 > x0) & (y1 > y0);
+    }
+  }
+  dl->vertex_count = out * 4;
+  dl->index_count = out * 6;
+}
+
+
+void mu_drawlist_build(mu_Context *ctx, mu_DrawList *dl) {
+  mu_Command *cmd = NULL;
+  mu_Rect clip = unclipped_rect;
+  int quads = 0;
+
+  /* count the most quads the frame can produce so the buffers only grow once,
+  ** and are reused as-is by later frames */
+  while (mu_next_command(ctx, &cmd)) {
+    switch (cmd->type) {
+      case MU_COMMAND_RECT: case MU_COMMAND_ICON: quads++; break;
+      case MU_COMMAND_TEXT: quads += cmd->base.size - sizeof(mu_TextCommand); break;
+    }
+  }
+  drawlist_reserve(ctx, dl, quads);
+
+  /* gather every quad along with the clip rect active for it, so the whole
+  ** frame can be clipped and drawn in a single batch */
+  quads = 0;
+  cmd = NULL;
+  while (mu_next_command(ctx, &cmd)) {
+    switch (cmd->type) {
+      case MU_COMMAND_CLIP:
+        clip = cmd->clip.rect;
+        break;
+
+      case MU_COMMAND_RECT:
+        drawlist_push(dl, quads++, cmd->rect.rect, dl->white, cmd->rect.color,
+          clip);
+        break;
+
+      case MU_COMMAND_ICON: {
+        mu_Rect src = dl->icon_rect(cmd->icon.id);
+        mu_Rect r = cmd->icon.rect;
+        r.x += (r.w - src.w) / 2;
+        r.y += (r.h - src.h) / 2;
+        r.w = src.w;
+        r.h = src.h;
+        drawlist_push(dl, quads++, r, src, cmd->icon.color, clip);
+        break;
+      }
+
+      case MU_COMMAND_TEXT: {
+        /* one glyph per byte; utf-8 continuation bytes are skipped */
+        const char *p;
+        mu_Rect r = mu_rect(cmd->text.pos.x, cmd->text.pos.y, 0, 0);
+        for (p = cmd->text.str; *p; p++) {
+          mu_Rect src;
+          if ((*p & 0xc0) == 0x80) { continue; }
+          src = dl->glyph_rect(cmd->text.font, (unsigned char) *p);
+          r.w = src.w;
+          r.h = src.h;
+          drawlist_push(dl, quads++, r, src, cmd->text.color, clip);
+          r.x += r.w;
+        }
+        break;
+      }
+    }
+  }
+
+  drawlist_clip(dl, quads);
+  drawlist_emit(dl, quads);
+}
+
+
+void mu_drawlist_deinit(mu_Context *ctx, mu_DrawList *dl) {
+  if (dl->quad_cap) {
+    ctx->alloc(ctx, dl->vertices, 0);
+    ctx->alloc(ctx, dl->indices, 0);
+    ctx->alloc(ctx, dl->quad_blocks, 0);
+  }
+  dl->vertices = NULL;
+  dl->indices = NULL;
+  dl->quad_blocks = NULL;
+  dl->vertex_count = dl->index_count = dl->quad_cap = 0;
 }
 
 
@@ -654,9 +1761,9 @@ void mu_draw_control_text(mu_Context *ctx, const char *str, mu_Rect rect,
 {
   mu_Vec2 pos;
   mu_Font font = ctx->style->font;
-  int tw = ctx->text_width(font, str, -1);
+  int tw = text_width(ctx, font, str, -1);
   mu_push_clip_rect(ctx, rect);
-  pos.y = rect.y + (rect.h - ctx->text_height(font)) / 2;
+  pos.y = rect.y + (rect.h - text_height(ctx, font)) / 2;
   if (opt & MU_OPT_ALIGNCENTER) {
     pos.x = rect.x + (rect.w - tw) / 2;
   } else if (opt & MU_OPT_ALIGNRIGHT) {
@@ -698,13 +1805,173 @@ void mu_update_control(mu_Context *ctx, mu_Id id, mu_Rect rect, int opt) {
 }
 
 
-void mu_text(mu_Context *ctx, const char *text) {
-  const char *start, *end, *p = text;
-  int width = -1;
-  mu_Font font = ctx->style->font;
+static void grow_ints(mu_Context *ctx, int **items, int *cap, int n) {
+  if (n <= *cap) { return; }
+  *cap = mu_max(n, mu_max(*cap * 2, 64));
+  *items = ctx->alloc(ctx, *items, *cap * sizeof(int));
+  expect(*items);
+}
+
+
+/* measures each word of the text and the separator following it once, after
+** which wrapping at any width needs no further measuring */
+static void measure_words(mu_Context *ctx, mu_WrapCacheItem *item,
+  const char *text)
+{
+  const char *word, *p = text;
+  int *w, n = 0;
+  for (;;) {
+    word = p;
+    while (*p && *p != ' ' && *p != '\n') { p++; }
+    grow_ints(ctx, &item->words, &item->word_cap, (n + 1) * 3);
+    w = item->words + n++ * 3;
+    w[0] = p - text;
+    w[1] = text_width(ctx, item->font, word, p - word);
+    w[2] = text_width(ctx, item->font, p, 1);
+    if (!*p) { break; }
+    p++;
+  }
+  item->word_count = n;
+}
+
+
+/* breaks the measured words into lines the same way as the uncached loop in
+** `mu_text()`. a line's break only depends on where it starts and the width,
+** so a line starting where one did at the last width is copied if the width
+** is in the range that line fits without taking the next word; only the rest
+** are wrapped again, from the first line whose break changes to the end of
+** its paragraph */
+static void wrap_words(mu_Context *ctx, mu_WrapCacheItem *item,
+  const char *text, int width)
+{
+  const int *words = item->words, *old = item->lines;
+  int *tmp, *line, i = 0, k = 0, n = 0, start, end, w, fit, limit, cap;
+  int sync = 1;
+  do {
+    start = k > 0 ? words[(k - 1) * 3] + 1 : 0;
+    grow_ints(ctx, &item->next_lines, &item->next_line_cap, (n + 1) * 5);
+    line = item->next_lines + n++ * 5;
+    while (sync && i < item->line_count && old[i * 5] < start) { i++; }
+    if (sync && i < item->line_count && old[i * 5] == start &&
+        old[i * 5 + 3] <= width && width < old[i * 5 + 4]
+    ) {
+      memcpy(line, old + i * 5, 5 * sizeof(int));
+      end = line[1];
+      k = line[2];
+      continue;
+    }
+    w = fit = 0;
+    limit = INT_MAX;
+    end = start;
+    do {
+      w += words[k * 3 + 1];
+      if (end != start) {
+        if (w > width) { limit = w; break; }
+        fit = w;
+      }
+      w += words[k * 3 + 2];
+      end = words[k++ * 3];
+    } while (text[end] && text[end] != '\n');
+    line[0] = start;
+    line[1] = end;
+    line[2] = k;
+    line[3] = fit;
+    line[4] = limit;
+    /* the rest of the paragraph starts elsewhere than it did */
+    sync = text[end] == '\n';
+  } while (text[end]);
+  tmp = item->lines;
+  item->lines = item->next_lines;
+  item->next_lines = tmp;
+  cap = item->line_cap;
+  item->line_cap = item->next_line_cap;
+  item->next_line_cap = cap;
+  item->line_count = n;
+  item->width = width;
+}
+
+
+/* finds the lines of the text in the context's `wrap_cache`. entries are found
+** by the text's address and the id stack; a change of content or font measures
+** the words again, and a change of width only re-wraps them */
+static mu_WrapCacheItem* get_wrapped_text(mu_Context *ctx, const char *text,
+  mu_Font font, int width)
+{
+  mu_WrapCache *wc = ctx->wrap_cache;
+  mu_WrapCacheItem *item = NULL;
+  int i, idx = ctx->id_stack.idx, len = strlen(text);
+  mu_Id h = HASH_INITIAL;
+  mu_Id id = (idx > 0) ? ctx->id_stack.items[idx - 1] : HASH_INITIAL;
+  expect(ctx->alloc);
+  hash(&id, &text, sizeof(text));
+  hash(&h, text, len);
+  for (i = 0; i < MU_WRAPCACHE_SIZE; i++) {
+    mu_WrapCacheItem *it = &wc->items[i];
+    if (it->id == id) { item = it; break; }
+    if (!item || it->last_used < item->last_used) { item = it; }
+  }
+  if (!item->words || item->id != id || item->hash != h || item->len != len ||
+      item->font != font
+  ) {
+    item->id = id;
+    item->hash = h;
+    item->len = len;
+    item->font = font;
+    item->line_count = 0;
+    measure_words(ctx, item, text);
+    wrap_words(ctx, item, text, width);
+    wc->misses++;
+  } else if (item->width != width) {
+    wrap_words(ctx, item, text, width);
+    wc->rewraps++;
+  } else {
+    wc->hits++;
+  }
+  item->last_used = ctx->frame;
+  return item;
+}
+
+
+static void draw_wrapped_text(mu_Context *ctx, const char *text, mu_Font font,
+  mu_Color color)
+{
+  mu_Rect r = mu_layout_next(ctx), clip = mu_get_clip_rect(ctx);
+  mu_Layout *layout = get_layout(ctx);
+  mu_WrapCacheItem *item = get_wrapped_text(ctx, text, font, r.w);
+  int i, n = item->line_count, pitch = r.h + ctx->style->spacing;
+  /* draw the lines that can overlap the clip rect, leaving the exact test to
+  ** `mu_draw_text()` */
+  int first = mu_clamp((clip.y - r.y - r.h) / pitch, 0, n);
+  int last = mu_clamp((clip.y + clip.h - r.y) / pitch + 1, first, n);
+  for (i = first; i < last; i++) {
+    const int *line = item->lines + i * 5;
+    mu_draw_text(ctx, font, text + line[0], line[1] - line[0],
+      mu_vec2(r.x, r.y + i * pitch), color);
+  }
+  track(ctx->stats.text_lines += n);
+  track(ctx->stats.text_lines_drawn += last - first);
+  /* advance the layout past the other lines as `mu_layout_next()` would */
+  r.y += (n - 1) * pitch;
+  layout->position.y += (n - 1) * pitch;
+  layout->next_row = mu_max(layout->next_row, r.y - layout->body.y + pitch);
+  layout->max.y = mu_max(layout->max.y, r.y + r.h);
+  ctx->last_rect = r;
+}
+
+
+void mu_text(mu_Context *ctx, const char *text) {
+  const char *start, *end, *p = text;
+  int width = -1;
+  mu_Font font = ctx->style->font;
   mu_Color color = ctx->style->colors[MU_COLOR_TEXT];
+  mu_Rect clip = mu_get_clip_rect(ctx);
   mu_layout_begin_column(ctx);
-  mu_layout_row(ctx, 1, &width, ctx->text_height(font));
+  mu_layout_row(ctx, 1, &width, text_height(ctx, font));
+  if (ctx->wrap_cache) {
+    draw_wrapped_text(ctx, text, font, color);
+    mu_layout_end_column(ctx);
+    return;
+  }
   do {
     mu_Rect r = mu_layout_next(ctx);
     int w = 0;
@@ -712,12 +1979,17 @@ void mu_text(mu_Context *ctx, const char *text) {
     do {
       const char* word = p;
       while (*p && *p != ' ' && *p != '\n') { p++; }
-      w += ctx->text_width(font, word, p - word);
+      w += text_width(ctx, font, word, p - word);
       if (w > r.w && end != start) { break; }
-      w += ctx->text_width(font, p, 1);
+      w += text_width(ctx, font, p, 1);
       end = p++;
     } while (*end && *end != '\n');
-    mu_draw_text(ctx, font, start, end - start, mu_vec2(r.x, r.y), color);
+    /* skip measuring lines which are vertically outside of the clip rect */
+    track(ctx->stats.text_lines++);
+    if (r.y <= clip.y + clip.h && r.y + r.h >= clip.y) {
+      mu_draw_text(ctx, font, start, end - start, mu_vec2(r.x, r.y), color);
+      track(ctx->stats.text_lines_drawn++);
+    }
     p = end + 1;
   } while (*end);
   mu_layout_end_column(ctx);
@@ -730,9 +2002,14 @@ void mu_label(mu_Context *ctx, const char *text) {
 
 
 int mu_button_ex(mu_Context *ctx, const char *label, int icon, int opt) {
-  int res = 0;
   mu_Id id = label ? mu_get_id(ctx, label, strlen(label))
                    : mu_get_id(ctx, &icon, sizeof(icon));
+  return mu_button_id(ctx, id, label, icon, opt);
+}
+
+
+int mu_button_id(mu_Context *ctx, mu_Id id, const char *label, int icon, int opt) {
+  int res = 0;
   mu_Rect r = mu_layout_next(ctx);
   mu_update_control(ctx, id, r, opt);
   /* handle click */
@@ -748,8 +2025,12 @@ int mu_button_ex(mu_Context *ctx, const char *label, int icon, int opt) {
 
 
 int mu_checkbox(mu_Context *ctx, const char *label, int *state) {
+  return mu_checkbox_id(ctx, mu_get_id_ptr(ctx, state), label, state);
+}
+
+
+int mu_checkbox_id(mu_Context *ctx, mu_Id id, const char *label, int *state) {
   int res = 0;
-  mu_Id id = mu_get_id(ctx, &state, sizeof(state));
   mu_Rect r = mu_layout_next(ctx);
   mu_Rect box = mu_rect(r.x, r.y, r.h, r.h);
   mu_update_control(ctx, id, r, 0);
@@ -804,8 +2085,8 @@ int mu_textbox_raw(mu_Context *ctx, char *buf, int bufsz, mu_Id id, mu_Rect r,
   if (ctx->focus == id) {
     mu_Color color = ctx->style->colors[MU_COLOR_TEXT];
     mu_Font font = ctx->style->font;
-    int textw = ctx->text_width(font, buf, -1);
-    int texth = ctx->text_height(font);
+    int textw = text_width(ctx, font, buf, -1);
+    int texth = text_height(ctx, font);
     int ofx = r.w - ctx->style->padding - textw - 1;
     int textx = r.x + mu_min(ofx, ctx->style->padding);
     int texty = r.y + (r.h - texth) / 2;
@@ -843,7 +2124,7 @@ static int number_textbox(mu_Context *ctx, mu_Real *value, mu_Rect r, mu_Id id)
 
 
 int mu_textbox_ex(mu_Context *ctx, char *buf, int bufsz, int opt) {
-  mu_Id id = mu_get_id(ctx, &buf, sizeof(buf));
+  mu_Id id = mu_get_id_ptr(ctx, buf);
   mu_Rect r = mu_layout_next(ctx);
   return mu_textbox_raw(ctx, buf, bufsz, id, r, opt);
 }
@@ -851,12 +2132,19 @@ int mu_textbox_ex(mu_Context *ctx, char *buf, int bufsz, int opt) {
 
 int mu_slider_ex(mu_Context *ctx, mu_Real *value, mu_Real low, mu_Real high,
   mu_Real step, const char *fmt, int opt)
+{
+  mu_Id id = mu_get_id_ptr(ctx, value);
+  return mu_slider_id(ctx, id, value, low, high, step, fmt, opt);
+}
+
+
+int mu_slider_id(mu_Context *ctx, mu_Id id, mu_Real *value, mu_Real low,
+  mu_Real high, mu_Real step, const char *fmt, int opt)
 {
   char buf[MU_MAX_FMT + 1];
   mu_Rect thumb;
   int x, w, res = 0;
   mu_Real last = *value, v = last;
-  mu_Id id = mu_get_id(ctx, &value, sizeof(value));
   mu_Rect base = mu_layout_next(ctx);
 
   /* handle text input mode */
@@ -893,10 +2181,16 @@ int mu_slider_ex(mu_Context *ctx, mu_Real *value, mu_Real low, mu_Real high,
 
 int mu_number_ex(mu_Context *ctx, mu_Real *value, mu_Real step,
   const char *fmt, int opt)
+{
+  return mu_number_id(ctx, mu_get_id_ptr(ctx, value), value, step, fmt, opt);
+}
+
+
+int mu_number_id(mu_Context *ctx, mu_Id id, mu_Real *value, mu_Real step,
+  const char *fmt, int opt)
 {
   char buf[MU_MAX_FMT + 1];
   int res = 0;
-  mu_Id id = mu_get_id(ctx, &value, sizeof(value));
   mu_Rect base = mu_layout_next(ctx);
   mu_Real last = *value;
 
@@ -923,11 +2217,12 @@ int mu_number_ex(mu_Context *ctx, mu_Real *value, mu_Real step,
 }
 
 
-static int header(mu_Context *ctx, const char *label, int istreenode, int opt) {
+static int header(mu_Context *ctx, mu_Id id, const char *label, int istreenode,
+  int opt)
+{
   mu_Rect r;
   int active, expanded;
-  mu_Id id = mu_get_id(ctx, label, strlen(label));
-  int idx = mu_pool_get(ctx, ctx->treenode_pool, MU_TREENODEPOOL_SIZE, id);
+  int idx = mu_pool_get(ctx, &ctx->treenode_pool, id);
   int width = -1;
   mu_layout_row(ctx, 1, &width, 0);
 
@@ -941,10 +2236,10 @@ static int header(mu_Context *ctx, const char *label, int istreenode, int opt) {
 
   /* update pool ref */
   if (idx >= 0) {
-    if (active) { mu_pool_update(ctx, ctx->treenode_pool, idx); }
-           else { memset(&ctx->treenode_pool[idx], 0, sizeof(mu_PoolItem)); }
+    if (active) { mu_pool_update(ctx, &ctx->treenode_pool, idx); }
+           else { mu_pool_remove(ctx, &ctx->treenode_pool, idx); }
   } else if (active) {
-    mu_pool_init(ctx, ctx->treenode_pool, MU_TREENODEPOOL_SIZE, id);
+    mu_pool_init(ctx, &ctx->treenode_pool, id);
   }
 
   /* draw */
@@ -965,15 +2260,27 @@ static int header(mu_Context *ctx, const char *label, int istreenode, int opt) {
 
 
 int mu_header_ex(mu_Context *ctx, const char *label, int opt) {
-  return header(ctx, label, 0, opt);
+  mu_Id id = mu_get_id(ctx, label, strlen(label));
+  return header(ctx, id, label, 0, opt);
+}
+
+
+int mu_header_id(mu_Context *ctx, mu_Id id, const char *label, int opt) {
+  return header(ctx, id, label, 0, opt);
 }
 
 
 int mu_begin_treenode_ex(mu_Context *ctx, const char *label, int opt) {
-  int res = header(ctx, label, 1, opt);
+  mu_Id id = mu_get_id(ctx, label, strlen(label));
+  return mu_begin_treenode_id(ctx, id, label, opt);
+}
+
+
+int mu_begin_treenode_id(mu_Context *ctx, mu_Id id, const char *label, int opt) {
+  int res = header(ctx, id, label, 1, opt);
   if (res & MU_RES_ACTIVE) {
     get_layout(ctx)->indent += ctx->style->indent;
-    push(ctx->id_stack, ctx->last_id);
+    push(ctx->id_stack, id);
   }
   return res;
 }
@@ -992,7 +2299,7 @@ void mu_end_treenode(mu_Context *ctx) {
                                                                             \
     if (maxscroll > 0 && b->h > 0) {                                        \
       mu_Rect base, thumb;                                                  \
-      mu_Id id = mu_get_id(ctx, "!scrollbar" #y, 11);                       \
+      mu_Id id = get_child_id(ctx, ID_SCROLLBAR_##y);                       \
                                                                             \
       /* get sizing / positioning */                                        \
       base = *b;                                                            \
@@ -1049,11 +2356,31 @@ static void push_container_body(
 }
 
 
+#ifdef MU_STATS
+static void stats_root_name(mu_Context *ctx, int idx, const char *name) {
+  mu_RootStats *rs = &ctx->stats.roots[idx];
+  strncpy(rs->name, name, sizeof(rs->name) - 1);
+}
+#endif
+
+
 static void begin_root_container(mu_Context *ctx, mu_Container *cnt) {
   push(ctx->container_stack, cnt);
+  /* segments are drawn in zindex order, so each starts and ends unclipped */
+  reset_clip(ctx);
   /* push container to roots list and push head command */
   push(ctx->root_list, cnt);
+#ifdef MU_STATS
+  {
+    mu_RootStats *rs = &ctx->stats.roots[ctx->root_list.idx - 1];
+    memset(rs, 0, sizeof(*rs));
+    rs->parent = ctx->stats.current_root;
+    ctx->stats.current_root = ctx->root_list.idx - 1;
+  }
+#endif
   cnt->head = push_jump(ctx, NULL);
+  /* the container's frame border is drawn one pixel outside of its rect */
+  cnt->draw_rect = expand_rect(cnt->rect, 1);
   /* set as hover root if the mouse is overlapping this container and it has a
   ** higher zindex than the current hover root */
   if (rect_overlaps_vec2(cnt->rect, ctx->mouse_pos) &&
@@ -1072,8 +2399,10 @@ static void end_root_container(mu_Context *ctx) {
   /* push tail 'goto' jump command and set head 'skip' command. the final steps
   ** on initing these are done in mu_end() */
   mu_Container *cnt = mu_get_current_container(ctx);
+  reset_clip(ctx);
   cnt->tail = push_jump(ctx, NULL);
   cnt->head->jump.dst = ctx->command_list.items + ctx->command_list.idx;
+  track(ctx->stats.current_root = ctx->stats.roots[ctx->stats.current_root].parent);
   /* pop base clip rect and container */
   mu_pop_clip_rect(ctx);
   pop_container(ctx);
@@ -1081,14 +2410,22 @@ static void end_root_container(mu_Context *ctx) {
 
 
 int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt) {
-  mu_Rect body;
   mu_Id id = mu_get_id(ctx, title, strlen(title));
+  return mu_begin_window_id(ctx, id, title, rect, opt);
+}
+
+
+int mu_begin_window_id(mu_Context *ctx, mu_Id id, const char *title,
+  mu_Rect rect, int opt)
+{
+  mu_Rect body;
   mu_Container *cnt = get_container(ctx, id, opt);
   if (!cnt || !cnt->open) { return 0; }
   push(ctx->id_stack, id);
 
   if (cnt->rect.w == 0) { cnt->rect = rect; }
   begin_root_container(ctx, cnt);
+  track(stats_root_name(ctx, ctx->stats.current_root, title));
   rect = body = cnt->rect;
 
   /* draw frame */
@@ -1104,7 +2441,7 @@ int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt
 
     /* do title text */
     if (~opt & MU_OPT_NOTITLE) {
-      mu_Id id = mu_get_id(ctx, "!title", 6);
+      mu_Id id = get_child_id(ctx, ID_TITLE);
       mu_update_control(ctx, id, tr, opt);
       mu_draw_control_text(ctx, title, tr, MU_COLOR_TITLETEXT, opt);
       if (id == ctx->focus && ctx->mouse_down == MU_MOUSE_LEFT) {
@@ -1117,7 +2454,7 @@ int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt
 
     /* do `close` button */
     if (~opt & MU_OPT_NOCLOSE) {
-      mu_Id id = mu_get_id(ctx, "!close", 6);
+      mu_Id id = get_child_id(ctx, ID_CLOSE);
       mu_Rect r = mu_rect(tr.x + tr.w - tr.h, tr.y, tr.h, tr.h);
       tr.w -= r.w;
       mu_draw_icon(ctx, MU_ICON_CLOSE, r, ctx->style->colors[MU_COLOR_TITLETEXT]);
@@ -1133,7 +2470,7 @@ int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt
   /* do `resize` handle */
   if (~opt & MU_OPT_NORESIZE) {
     int sz = ctx->style->title_height;
-    mu_Id id = mu_get_id(ctx, "!resize", 7);
+    mu_Id id = get_child_id(ctx, ID_RESIZE);
     mu_Rect r = mu_rect(rect.x + rect.w - sz, rect.y + rect.h - sz, sz, sz);
     mu_update_control(ctx, id, r, opt);
     if (id == ctx->focus && ctx->mouse_down == MU_MOUSE_LEFT) {
@@ -1153,15 +2490,115 @@ int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt
   if (opt & MU_OPT_POPUP && ctx->mouse_pressed && ctx->hover_root != cnt) {
     cnt->open = 0;
   }
+  if (opt & MU_OPT_POPUP && cnt->open) { ctx->frame_flags |= MU_FRAME_ACTIVE; }
 
   mu_push_clip_rect(ctx, cnt->body);
   return MU_RES_ACTIVE;
 }
 
 
+static void store_window_cache(mu_Context *ctx, mu_Container *cnt) {
+  mu_WindowCache *c = cnt->cache;
+  mu_Command *cmd = (mu_Command*) ((char*) cnt->head + sizeof(mu_JumpCommand));
+  int focused = ctx->updated_focus;
+  ctx->updated_focus |= c->updated_focus;
+  c->building = 0;
+  /* the segment can only be reused if it does not depend on the mouse or
+  ** focus, holds no other root containers and its content size was stable */
+  c->valid = !focused &&
+    ctx->root_list.idx == c->root_idx + 1 &&
+    !rect_overlaps_vec2(c->rect, ctx->mouse_pos) &&
+    c->content_size.x == cnt->content_size.x &&
+    c->content_size.y == cnt->content_size.y;
+  if (!c->valid) { return; }
+  /* copy segment's commands, dropping the jumps between command chunks */
+  c->idx = 0;
+  while (cmd != cnt->tail) {
+    if (cmd->type == MU_COMMAND_JUMP) { cmd = cmd->jump.dst; continue; }
+    if (c->idx + cmd->base.size > c->size) {
+      c->size = mu_max(c->idx + cmd->base.size, c->size * 2);
+      c->items = ctx->alloc(ctx, c->items, c->size);
+      expect(c->items);
+    }
+    memcpy(c->items + c->idx, cmd, cmd->base.size);
+    c->idx += cmd->base.size;
+    cmd = (mu_Command*) ((char*) cmd + cmd->base.size);
+  }
+}
+
+
 void mu_end_window(mu_Context *ctx) {
+  mu_Container *cnt = mu_get_current_container(ctx);
   mu_pop_clip_rect(ctx);
   end_root_container(ctx);
+  if (cnt->cache && cnt->cache->building) { store_window_cache(ctx, cnt); }
+}
+
+
+static void replay_window_cache(mu_Context *ctx, mu_Container *cnt) {
+  mu_WindowCache *c = cnt->cache;
+  int i;
+  begin_root_container(ctx, cnt);
+  for (i = 0; i < c->idx; ) {
+    mu_Command *src = (mu_Command*) (c->items + i);
+    mu_Command *cmd = mu_push_command(ctx, src->type, src->base.size);
+    memcpy(cmd, src, src->base.size);
+    i += src->base.size;
+  }
+  /* no layout or id was pushed, so `end_root_container` can't be used */
+  cnt->tail = push_jump(ctx, NULL);
+  cnt->head->jump.dst = ctx->command_list.items + ctx->command_list.idx;
+  track(ctx->stats.current_root = ctx->stats.roots[ctx->stats.current_root].parent);
+  mu_pop_clip_rect(ctx);
+  pop(ctx->container_stack);
+}
+
+
+int mu_begin_window_cached(mu_Context *ctx, const char *title, mu_Rect rect,
+  int opt, unsigned version)
+{
+  mu_Id id = mu_get_id(ctx, title, strlen(title));
+  mu_Container *cnt = get_container(ctx, id, opt);
+  mu_WindowCache *c;
+  if (!cnt || !cnt->open) { return 0; }
+  /* only containers of cached windows carry a cache */
+  if (!cnt->cache) {
+    expect(ctx->alloc);
+    cnt->cache = ctx->alloc(ctx, NULL, sizeof(mu_WindowCache));
+    expect(cnt->cache);
+    memset(cnt->cache, 0, sizeof(mu_WindowCache));
+  }
+  c = cnt->cache;
+
+  /* reuse last segment if nothing it was built from has changed */
+  if (c->valid && c->version == version && c->opt == opt &&
+      ~opt & MU_OPT_POPUP &&
+      rects_equal(c->rect, cnt->rect) &&
+      c->scroll.x == cnt->scroll.x && c->scroll.y == cnt->scroll.y &&
+      c->content_size.x == cnt->content_size.x &&
+      c->content_size.y == cnt->content_size.y &&
+      !rect_overlaps_vec2(cnt->rect, ctx->mouse_pos)
+  ) {
+    replay_window_cache(ctx, cnt);
+    track(stats_root_name(ctx, ctx->root_list.idx - 1, title));
+    return 0;
+  }
+
+  /* otherwise build the window as usual, storing its segment at the end. the
+  ** focus flag is cleared to find out if any of the window's controls (its
+  ** title bar and scrollbars included) hold the focus */
+  c->updated_focus = ctx->updated_focus;
+  ctx->updated_focus = 0;
+  c->valid = 0;
+  c->building = 1;
+  mu_begin_window_id(ctx, id, title, rect, opt);
+  c->version = version;
+  c->opt = opt;
+  c->rect = cnt->rect;
+  c->scroll = cnt->scroll;
+  c->content_size = cnt->content_size;
+  c->root_idx = ctx->root_list.idx - 1;
+  return MU_RES_ACTIVE;
 }
 
 
@@ -1189,9 +2626,14 @@ void mu_end_popup(mu_Context *ctx) {
 
 
 void mu_begin_panel_ex(mu_Context *ctx, const char *name, int opt) {
+  mu_begin_panel_id(ctx, mu_get_id(ctx, name, strlen(name)), opt);
+}
+
+
+void mu_begin_panel_id(mu_Context *ctx, mu_Id id, int opt) {
   mu_Container *cnt;
-  mu_push_id(ctx, name, strlen(name));
-  cnt = get_container(ctx, ctx->last_id, opt);
+  push(ctx->id_stack, id);
+  cnt = get_container(ctx, id, opt);
   cnt->rect = mu_layout_next(ctx);
   if (~opt & MU_OPT_NOFRAME) {
     ctx->draw_frame(ctx, cnt->rect, MU_COLOR_PANELBG);
@@ -1206,3 +2648,844 @@ void mu_end_panel(mu_Context *ctx) {
   mu_pop_clip_rect(ctx);
   pop_container(ctx);
 }
+
+
+void mu_begin_clipper(mu_Context *ctx, mu_Clipper *clipper, int count, int height) {
+  mu_Layout *layout = get_layout(ctx);
+  /* control borders are drawn one pixel outside of their rects */
+  mu_Rect clip = expand_rect(mu_get_clip_rect(ctx), 1);
+  int pitch, top, bottom;
+  if (height == 0) { height = ctx->style->size.y + ctx->style->padding * 2; }
+  pitch = height + ctx->style->spacing;
+  /* start the rows on a new line of the current layout */
+  mu_layout_row(ctx, layout->items, NULL, height);
+  clipper->count = count;
+  clipper->height = height;
+  clipper->start = layout->position.y;
+  /* get range of rows overlapping the clip rect */
+  top = clip.y - (layout->body.y + clipper->start);
+  bottom = top + clip.h;
+  clipper->first = mu_clamp(top / pitch, 0, count);
+  clipper->last = mu_clamp((bottom + pitch - 1) / pitch, clipper->first, count);
+  if (bottom <= 0) { clipper->first = clipper->last = 0; }
+  /* skip the layout over the rows above the first visible one */
+  layout->next_row = clipper->start + clipper->first * pitch;
+  mu_layout_row(ctx, layout->items, NULL, height);
+}
+
+
+void mu_end_clipper(mu_Context *ctx, mu_Clipper *clipper) {
+  mu_Layout *layout = get_layout(ctx);
+  int pitch = clipper->height + ctx->style->spacing;
+  if (clipper->count == 0) { return; }
+  /* skip the layout over the remaining rows, extending the content size as if
+  ** they had all been processed */
+  layout->next_row = clipper->start + clipper->count * pitch;
+  layout->max.y = mu_max(layout->max.y,
+    layout->body.y + layout->next_row - ctx->style->spacing);
+  mu_layout_row(ctx, layout->items, NULL, clipper->height);
+}
+
+
+int mu_table_ex(mu_Context *ctx, const char *name, mu_Column *columns,
+  int ncolumns, int rows,
+  void (*cell)(mu_Context *ctx, void *udata, int row, int col, mu_Rect rect),
+  void *udata, int opt)
+{
+  mu_Rect r = mu_layout_next(ctx);
+  mu_Rect clip, origin;
+  mu_Container *cnt;
+  int h = ctx->style->size.y + ctx->style->padding * 2;
+  int i, row, x, width = 0, first, last, res = 0;
+  for (i = 0; i < ncolumns; i++) { width += columns[i].width; }
+
+  /* the body is a panel below the header row; its content size is set to the
+  ** size of the whole table without laying out any of its cells */
+  mu_layout_set_next(ctx, mu_rect(r.x, r.y + h, r.w, r.h - h), 0);
+  mu_begin_panel_ex(ctx, name, opt);
+  cnt = mu_get_current_container(ctx);
+  mu_layout_set_next(ctx, mu_rect(0, 0, width, rows * h), 1);
+  origin = mu_layout_next(ctx);
+
+  /* call `cell` for the visible cells only */
+  clip = mu_get_clip_rect(ctx);
+  first = mu_clamp((clip.y - origin.y) / h, 0, rows);
+  last = mu_clamp((clip.y + clip.h - origin.y + h - 1) / h, first, rows);
+  for (i = 0, x = origin.x; i < ncolumns; x += columns[i++].width) {
+    if (x + columns[i].width <= clip.x) { continue; }
+    if (x >= clip.x + clip.w) { break; }
+    for (row = first; row < last; row++) {
+      cell(ctx, udata, row, i, mu_rect(x, origin.y + row * h, columns[i].width, h));
+    }
+  }
+  mu_end_panel(ctx);
+
+  /* do header row, scrolled horizontally with the body */
+  mu_push_id(ctx, name, strlen(name));
+  mu_push_clip_rect(ctx, mu_rect(cnt->body.x, r.y, cnt->body.w, h));
+  for (i = 0, x = origin.x; i < ncolumns; x += columns[i++].width) {
+    mu_Rect cr = mu_rect(x, r.y, columns[i].width, h);
+    mu_Rect hr = mu_rect(cr.x + cr.w - ctx->style->padding, cr.y,
+      ctx->style->padding * 2, cr.h);
+    mu_Id id = mu_get_id(ctx, &i, sizeof(i));
+    if (cr.x + cr.w + ctx->style->padding <= cnt->body.x) { continue; }
+    if (cr.x >= cnt->body.x + cnt->body.w) { break; }
+    ctx->draw_frame(ctx, cr, MU_COLOR_BUTTON);
+    mu_draw_control_text(ctx, columns[i].label, cr, MU_COLOR_TEXT, 0);
+    /* handle resizing by dragging the column's right edge */
+    mu_update_control(ctx, id, hr, 0);
+    if (ctx->focus == id && ctx->mouse_down == MU_MOUSE_LEFT && ctx->mouse_delta.x) {
+      columns[i].width = mu_max(h, columns[i].width + ctx->mouse_delta.x);
+      res |= MU_RES_CHANGE;
+    }
+  }
+  mu_pop_clip_rect(ctx);
+  mu_pop_id(ctx);
+  return res;
+}
+
+
+/*============================================================================
+** text editor
+**============================================================================*/
+
+static int edit_line_start(mu_TextEdit *te, int line) {
+  return line < te->line_gap ? te->lines[line]
+                             : te->len - te->lines[line + te->line_gap_len];
+}
+
+
+static int edit_line_end(mu_TextEdit *te, int line) {
+  return line + 1 < te->line_count ? edit_line_start(te, line + 1) - 1 : te->len;
+}
+
+
+static int* edit_width(mu_TextEdit *te, int line) {
+  return &te->widths[line < te->line_gap ? line : line + te->line_gap_len];
+}
+
+
+/* called before lines `first` to `last` change in a way that can make them
+** narrower; if one of them was, or may since have grown to be, the widest,
+** the widest is found again */
+static void edit_shrink(mu_TextEdit *te, int first, int last) {
+  int i, w;
+  for (i = first; i <= last && te->max_width >= 0; i++) {
+    w = *edit_width(te, i);
+    if (w < 0 || w == te->max_width) { te->max_width = -1; }
+  }
+}
+
+
+static void edit_update_max_width(mu_TextEdit *te) {
+  int i;
+  if (te->max_width >= 0) { return; }
+  te->max_width = 0;
+  for (i = 0; i < te->line_count; i++) {
+    te->max_width = mu_max(te->max_width, *edit_width(te, i));
+  }
+}
+
+
+static int edit_char(mu_TextEdit *te, int pos) {
+  return te->text[pos < te->gap ? pos : pos + te->gap_len];
+}
+
+
+static int edit_line_of(mu_TextEdit *te, int pos) {
+  int lo = 0, hi = te->line_count - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (edit_line_start(te, mid) <= pos) { lo = mid; } else { hi = mid - 1; }
+  }
+  return lo;
+}
+
+
+static int edit_next(mu_TextEdit *te, int pos) {
+  if (pos < te->len) { pos++; }
+  while (pos < te->len && (edit_char(te, pos) & 0xc0) == 0x80) { pos++; }
+  return pos;
+}
+
+
+static int edit_prev(mu_TextEdit *te, int pos) {
+  if (pos > 0) { pos--; }
+  while (pos > 0 && (edit_char(te, pos) & 0xc0) == 0x80) { pos--; }
+  return pos;
+}
+
+
+static void edit_move_gap(mu_TextEdit *te, int pos) {
+  char *t = te->text;
+  if (pos < te->gap) {
+    memmove(t + pos + te->gap_len, t + pos, te->gap - pos);
+  } else {
+    memmove(t + te->gap, t + te->gap + te->gap_len, pos - te->gap);
+  }
+  te->gap = pos;
+}
+
+
+/* moves the gap of the line index to before `line`. entries crossing it are
+** converted, as those after the gap count from the end of the text so that
+** edits before them leave them unchanged */
+static void edit_move_line_gap(mu_TextEdit *te, int line) {
+  int *l = te->lines, *w = te->widths, n = te->line_gap_len;
+  while (te->line_gap > line) {
+    int i = --te->line_gap;
+    l[i + n] = te->len - l[i];
+    w[i + n] = w[i];
+  }
+  while (te->line_gap < line) {
+    int i = te->line_gap++;
+    l[i] = te->len - l[i + n];
+    w[i] = w[i + n];
+  }
+}
+
+
+/* grows the gaps of the text and of the line index to at least `len` bytes
+** and `lines` entries */
+static void edit_reserve(mu_Context *ctx, mu_TextEdit *te, int len, int lines) {
+  if (te->gap_len < len) {
+    int size = mu_max(te->size * 2, te->len + len + 256);
+    int tail = te->size - te->gap - te->gap_len;
+    expect(ctx->alloc);
+    /* a null byte is kept past the end, so the text of the last line is
+    ** terminated for `text_width` callbacks that read up to it */
+    te->text = ctx->alloc(ctx, te->text, size + 1);
+    expect(te->text);
+    memmove(te->text + size - tail, te->text + te->gap + te->gap_len, tail);
+    te->text[size] = '\0';
+    te->gap_len = size - te->len;
+    te->size = size;
+  }
+  if (te->line_gap_len < lines) {
+    int size = mu_max(te->line_size * 2, te->line_count + lines + 64);
+    int tail = te->line_size - te->line_gap - te->line_gap_len;
+    expect(ctx->alloc);
+    te->lines = ctx->alloc(ctx, te->lines, size * sizeof(int));
+    te->widths = ctx->alloc(ctx, te->widths, size * sizeof(int));
+    expect(te->lines && te->widths);
+    memmove(te->lines + size - tail, te->lines + te->line_gap + te->line_gap_len,
+      tail * sizeof(int));
+    memmove(te->widths + size - tail, te->widths + te->line_gap + te->line_gap_len,
+      tail * sizeof(int));
+    te->line_gap_len = size - te->line_count;
+    te->line_size = size;
+  }
+}
+
+
+static void edit_init(mu_Context *ctx, mu_TextEdit *te) {
+  if (te->line_count > 0) { return; }
+  /* an empty text still has one line; a byte of gap is always kept for the
+  ** terminator added by `mu_textedit_text()` */
+  edit_reserve(ctx, te, 1, 1);
+  te->lines[0] = 0;
+  te->widths[0] = -1;
+  te->line_gap = te->line_count = 1;
+  te->line_gap_len--;
+  te->cursor_x = -1;
+}
+
+
+static void edit_insert(mu_Context *ctx, mu_TextEdit *te, int pos,
+  const char *str, int n)
+{
+  int i, line = edit_line_of(te, pos), lines = 0;
+  for (i = 0; i < n; i++) { lines += (str[i] == '\n'); }
+  /* a line only gets narrower if it is split */
+  if (lines > 0) { edit_shrink(te, line, line); }
+  edit_reserve(ctx, te, n + 1, lines);
+  edit_move_line_gap(te, line + 1);
+  edit_move_gap(te, pos);
+  memcpy(te->text + pos, str, n);
+  te->gap += n;
+  te->gap_len -= n;
+  te->len += n;
+  *edit_width(te, line) = -1;
+  for (i = 0; i < n; i++) {
+    if (str[i] != '\n') { continue; }
+    te->lines[te->line_gap] = pos + i + 1;
+    te->widths[te->line_gap] = -1;
+    te->line_gap++;
+    te->line_gap_len--;
+    te->line_count++;
+  }
+}
+
+
+static void edit_delete(mu_TextEdit *te, int start, int end) {
+  int first = edit_line_of(te, start), last = edit_line_of(te, end);
+  edit_shrink(te, first, last);
+  /* drop the lines starting inside the deleted range */
+  edit_move_line_gap(te, last + 1);
+  te->line_gap -= last - first;
+  te->line_gap_len += last - first;
+  te->line_count -= last - first;
+  edit_move_gap(te, start);
+  te->gap_len += end - start;
+  te->len -= end - start;
+  *edit_width(te, first) = -1;
+}
+
+
+/* replaces the selection with `str` and places the cursor after it */
+static void edit_replace(mu_Context *ctx, mu_TextEdit *te, const char *str,
+  int n)
+{
+  int start = mu_min(te->cursor, te->anchor);
+  int end = mu_max(te->cursor, te->anchor);
+  if (end > start) { edit_delete(te, start, end); }
+  if (n > 0) { edit_insert(ctx, te, start, str, n); }
+  te->cursor = te->anchor = start + n;
+  te->cursor_x = -1;
+}
+
+
+/* returns the line's text, moving the gap out of it if needed */
+static const char* edit_line_text(mu_TextEdit *te, int line, int *len) {
+  int start = edit_line_start(te, line), end = edit_line_end(te, line);
+  if (te->gap > start && te->gap < end) { edit_move_gap(te, start); }
+  *len = end - start;
+  return te->text + (start < te->gap ? start : start + te->gap_len);
+}
+
+
+static int edit_line_width(mu_Context *ctx, mu_TextEdit *te, int line) {
+  int *w = edit_width(te, line), len;
+  if (*w < 0) {
+    const char *str = edit_line_text(te, line, &len);
+    *w = text_width(ctx, te->font, str, len);
+    if (te->max_width >= 0) { te->max_width = mu_max(te->max_width, *w); }
+  }
+  return *w;
+}
+
+
+/* x offset of `pos` from the start of its line */
+static int edit_x(mu_Context *ctx, mu_TextEdit *te, int line, int pos) {
+  int len, n = pos - edit_line_start(te, line);
+  const char *str = edit_line_text(te, line, &len);
+  if (n == len) { return edit_line_width(ctx, te, line); }
+  return text_width(ctx, te->font, str, n);
+}
+
+
+/* finds the character boundary of the line nearest to `x` by bisection, so
+** only a few prefixes of long lines are measured */
+static int edit_pos_at(mu_Context *ctx, mu_TextEdit *te, int line, int x) {
+  int len, lo = 0, hi, mid;
+  const char *str = edit_line_text(te, line, &len);
+  hi = len;
+  while (lo < hi) {
+    mid = (lo + hi + 1) / 2;
+    while (mid < hi && (str[mid] & 0xc0) == 0x80) { mid++; }
+    if (text_width(ctx, te->font, str, mid) <= x) { lo = mid; continue; }
+    hi = mid - 1;
+    while (hi > lo && (str[hi] & 0xc0) == 0x80) { hi--; }
+  }
+  if (lo < len) {
+    hi = lo + 1;
+    while (hi < len && (str[hi] & 0xc0) == 0x80) { hi++; }
+    if (x - text_width(ctx, te->font, str, lo) >
+        text_width(ctx, te->font, str, hi) - x) { lo = hi; }
+  }
+  return edit_line_start(te, line) + lo;
+}
+
+
+/* applies the pressed `key` bits with the modifier keys `mods` held */
+static int edit_key(mu_Context *ctx, mu_TextEdit *te, int key, int mods,
+  int page)
+{
+  int res = 0, pos = -1, dy = 0, line;
+  /* edit */
+  if (key & MU_KEY_RETURN) {
+    edit_replace(ctx, te, "\n", 1);
+    res |= MU_RES_CHANGE;
+  }
+  if (key & (MU_KEY_BACKSPACE | MU_KEY_DELETE) && te->cursor == te->anchor) {
+    te->anchor = (key & MU_KEY_BACKSPACE) ? edit_prev(te, te->cursor)
+                                          : edit_next(te, te->cursor);
+  }
+  if (key & (MU_KEY_BACKSPACE | MU_KEY_DELETE) && te->cursor != te->anchor) {
+    edit_replace(ctx, te, "", 0);
+    res |= MU_RES_CHANGE;
+  }
+  /* move the cursor, extending the selection if shift is held */
+  line = edit_line_of(te, te->cursor);
+  if (key & MU_KEY_LEFT)  { pos = edit_prev(te, te->cursor); }
+  if (key & MU_KEY_RIGHT) { pos = edit_next(te, te->cursor); }
+  if (key & MU_KEY_HOME) {
+    pos = (mods & MU_KEY_CTRL) ? 0 : edit_line_start(te, line);
+  }
+  if (key & MU_KEY_END) {
+    pos = (mods & MU_KEY_CTRL) ? te->len : edit_line_end(te, line);
+  }
+  if (key & MU_KEY_UP)       { dy -= 1; }
+  if (key & MU_KEY_DOWN)     { dy += 1; }
+  if (key & MU_KEY_PAGEUP)   { dy -= page; }
+  if (key & MU_KEY_PAGEDOWN) { dy += page; }
+  if (pos >= 0) { te->cursor_x = -1; }
+  if (dy) {
+    if (te->cursor_x < 0) { te->cursor_x = edit_x(ctx, te, line, te->cursor); }
+    line = mu_clamp(line + dy, 0, te->line_count - 1);
+    pos = edit_pos_at(ctx, te, line, te->cursor_x);
+  }
+  if (pos >= 0) {
+    te->cursor = pos;
+    if (~mods & MU_KEY_SHIFT) { te->anchor = pos; }
+  }
+  return res;
+}
+
+
+/* applies the frame's key presses and text in the order they were input */
+static int edit_keys(mu_Context *ctx, mu_TextEdit *te, int page) {
+  mu_Event *e = NULL;
+  int res = 0, keys = 0, mods = ctx->key_down;
+  int n = strlen(ctx->input_text);
+  /* find the keys held when the frame began. input folded into the frame
+  ** ahead of its events by a full queue has no event of its own: its text
+  ** is what precedes the events' text, its keys those pressed without one */
+  while (mu_next_event(ctx, &e)) {
+    switch (e->type) {
+      case MU_EVENT_KEYDOWN: mods &= ~e->value; keys |= e->value; break;
+      case MU_EVENT_KEYUP:   mods |= e->value; break;
+      case MU_EVENT_TEXT:    n -= strlen(e->text); break;
+    }
+  }
+  if (n > 0) {
+    edit_replace(ctx, te, ctx->input_text, n);
+    res |= MU_RES_CHANGE;
+  }
+  if (ctx->key_pressed & ~keys) {
+    res |= edit_key(ctx, te, ctx->key_pressed & ~keys, mods, page);
+  }
+  /* then replay the events */
+  e = NULL;
+  while (mu_next_event(ctx, &e)) {
+    switch (e->type) {
+      case MU_EVENT_KEYDOWN:
+        mods |= e->value;
+        res |= edit_key(ctx, te, e->value, mods, page);
+        break;
+      case MU_EVENT_KEYUP:
+        mods &= ~e->value;
+        break;
+      case MU_EVENT_TEXT:
+        edit_replace(ctx, te, e->text, strlen(e->text));
+        res |= MU_RES_CHANGE;
+        break;
+    }
+  }
+  return res;
+}
+
+
+int mu_textedit_ex(mu_Context *ctx, mu_TextEdit *te, int opt) {
+  mu_Id id = mu_get_id_ptr(ctx, te);
+  return mu_textedit_id(ctx, id, te, opt);
+}
+
+
+int mu_textedit_id(mu_Context *ctx, mu_Id id, mu_TextEdit *te, int opt) {
+  enum {
+    EDIT_KEYS = MU_KEY_BACKSPACE | MU_KEY_RETURN | MU_KEY_DELETE | MU_KEY_LEFT |
+      MU_KEY_RIGHT | MU_KEY_UP | MU_KEY_DOWN | MU_KEY_HOME | MU_KEY_END |
+      MU_KEY_PAGEUP | MU_KEY_PAGEDOWN
+  };
+  mu_Font font = ctx->style->font;
+  mu_Color color = ctx->style->colors[MU_COLOR_TEXT];
+  int pad = ctx->style->padding, lh = text_height(ctx, font);
+  int i, first, last, line, res = 0, follow = 0;
+  int sel_start, sel_end;
+  mu_Rect r = mu_layout_next(ctx), clip, origin;
+  mu_Container *cnt = get_container(ctx, id, 0);
+
+  edit_init(ctx, te);
+  if (te->font != font) {
+    for (i = 0; i < te->line_count; i++) { *edit_width(te, i) = -1; }
+    te->font = font;
+    te->max_width = 0;
+  }
+  mu_update_control(ctx, id, r, opt | MU_OPT_HOLDFOCUS);
+
+  if (ctx->focus == id) {
+    /* place the cursor with the mouse, selecting while it is dragged */
+    if (ctx->mouse_down == MU_MOUSE_LEFT &&
+        (!ctx->mouse_pressed || mu_mouse_over(ctx, cnt->body))
+    ) {
+      int x = ctx->mouse_pos.x - (cnt->body.x + pad - cnt->scroll.x);
+      int y = ctx->mouse_pos.y - (cnt->body.y + pad - cnt->scroll.y);
+      line = mu_clamp(y / lh, 0, te->line_count - 1);
+      te->cursor = edit_pos_at(ctx, te, line, x);
+      te->cursor_x = -1;
+      if (ctx->mouse_pressed && ~ctx->key_down & MU_KEY_SHIFT) {
+        te->anchor = te->cursor;
+      }
+      follow = !ctx->mouse_pressed;
+    }
+    /* handle typing and keys */
+    if (ctx->input_text[0] || ctx->key_pressed & EDIT_KEYS) {
+      res |= edit_keys(ctx, te, mu_max(1, (cnt->body.h - pad * 2) / lh));
+      follow = 1;
+    }
+  }
+
+  /* scroll the cursor into view; the content size is updated first so the
+  ** scrollbars allow it */
+  edit_update_max_width(te);
+  cnt->content_size = mu_vec2(te->max_width + 1, te->line_count * lh);
+  if (follow) {
+    int vw = cnt->body.w - pad * 2, vh = cnt->body.h - pad * 2;
+    int x, y;
+    line = edit_line_of(te, te->cursor);
+    x = edit_x(ctx, te, line, te->cursor);
+    y = line * lh;
+    cnt->scroll.x = mu_clamp(cnt->scroll.x, x + 1 - vw, x);
+    cnt->scroll.y = mu_clamp(cnt->scroll.y, y + lh - vh, y);
+  }
+
+  /* the body is a panel whose content size is set without laying out any of
+  ** the lines; only the visible ones are measured and drawn */
+  mu_draw_control_frame(ctx, id, r, MU_COLOR_BASE, opt);
+  mu_layout_set_next(ctx, r, 0);
+  mu_begin_panel_id(ctx, id, opt | MU_OPT_NOFRAME);
+  mu_layout_set_next(ctx,
+    mu_rect(0, 0, te->max_width + 1, te->line_count * lh), 1);
+  origin = mu_layout_next(ctx);
+  clip = mu_get_clip_rect(ctx);
+  first = mu_clamp((clip.y - origin.y) / lh, 0, te->line_count);
+  last = mu_clamp((clip.y + clip.h - origin.y + lh - 1) / lh, first,
+    te->line_count);
+  sel_start = mu_min(te->cursor, te->anchor);
+  sel_end = mu_max(te->cursor, te->anchor);
+
+  for (i = first; i < last; i++) {
+    int start = edit_line_start(te, i), end = edit_line_end(te, i);
+    int y = origin.y + i * lh, w = edit_line_width(ctx, te, i), len;
+    const char *str;
+    /* selection, extended past the end of the line if it includes the
+    ** newline */
+    if (sel_start < sel_end && sel_start <= end && sel_end > start) {
+      int x0 = sel_start > start ? edit_x(ctx, te, i, sel_start) : 0;
+      int x1 = sel_end <= end ? edit_x(ctx, te, i, sel_end) : w + pad;
+      mu_draw_rect(ctx, mu_rect(origin.x + x0, y, x1 - x0, lh),
+        ctx->style->colors[MU_COLOR_BUTTONHOVER]);
+    }
+    str = edit_line_text(te, i, &len);
+    draw_text(ctx, font, str, len, mu_vec2(origin.x, y), color, w);
+    if (ctx->focus == id && te->cursor >= start && te->cursor <= end) {
+      int x = edit_x(ctx, te, i, te->cursor);
+      mu_draw_rect(ctx, mu_rect(origin.x + x, y, 1, lh), color);
+    }
+  }
+  mu_end_panel(ctx);
+  return res;
+}
+
+
+void mu_textedit_set(mu_Context *ctx, mu_TextEdit *te, const char *text,
+  int len)
+{
+  edit_init(ctx, te);
+  te->anchor = 0;
+  te->cursor = te->len;
+  edit_replace(ctx, te, text, len < 0 ? (int) strlen(text) : len);
+  te->cursor = te->anchor = 0;
+  te->max_width = 0;
+}
+
+
+void mu_textedit_insert(mu_Context *ctx, mu_TextEdit *te, const char *text,
+  int len)
+{
+  edit_init(ctx, te);
+  edit_replace(ctx, te, text, len < 0 ? (int) strlen(text) : len);
+}
+
+
+const char* mu_textedit_text(mu_Context *ctx, mu_TextEdit *te) {
+  edit_init(ctx, te);
+  edit_move_gap(te, te->len);
+  te->text[te->len] = '\0';
+  return te->text;
+}
+
+
+void mu_textedit_deinit(mu_Context *ctx, mu_TextEdit *te) {
+  if (te->text) { ctx->alloc(ctx, te->text, 0); }
+  if (te->lines) { ctx->alloc(ctx, te->lines, 0); }
+  if (te->widths) { ctx->alloc(ctx, te->widths, 0); }
+  memset(te, 0, sizeof(*te));
+}
+
+
+/*============================================================================
+** log view
+**============================================================================*/
+
+void mu_log_init(mu_Log *log, char *text, int text_size, mu_LogLine *lines,
+  int *matches, int line_cap)
+{
+  expect(text_size > 0);
+  memset(log, 0, sizeof(*log));
+  log->text = text;
+  log->text_size = text_size;
+  log->lines = lines;
+  log->matches = matches;
+  log->line_cap = line_cap;
+}
+
+
+void mu_log_clear(mu_Log *log) {
+  log->seq += log->count;
+  log->first = log->count = log->head = log->used = 0;
+  log->match_first = log->match_count = 0;
+  log->scan = log->seq;
+}
+
+
+static mu_LogLine* log_line(mu_Log *log, int seq) {
+  return &log->lines[(log->first + (seq - log->seq)) % log->line_cap];
+}
+
+
+static void log_drop(mu_Log *log) {
+  int start = log_line(log, log->seq)->start;
+  if (log->match_count > 0 && log->matches[log->match_first] == log->seq) {
+    log->match_first = (log->match_first + 1) % log->line_cap;
+    log->match_count--;
+  }
+  log->first = (log->first + 1) % log->line_cap;
+  log->count--;
+  log->seq++;
+  log->scan = mu_max(log->scan, log->seq);
+  /* free the bytes up to the next line, including any skipped at the end of
+  ** the ring */
+  if (log->count == 0) {
+    log->used = 0;
+  } else {
+    int n = log_line(log, log->seq)->start - start;
+    log->used -= n < 0 ? n + log->text_size : n;
+  }
+}
+
+
+static int log_match(mu_Log *log, mu_LogLine *line, int n) {
+  const char *str = log->text + line->start, *p;
+  int i;
+  for (i = 0; i + n <= line->len; i = p - str + 1) {
+    p = memchr(str + i, log->filter[0], line->len - n - i + 1);
+    if (!p) { return 0; }
+    if (!memcmp(p, log->filter, n)) { return 1; }
+  }
+  return 0;
+}
+
+
+/* checks lines against the filter until about `budget` bytes are read */
+static void log_scan(mu_Log *log, int budget) {
+  int n = strlen(log->filter);
+  while (budget > 0 && log->scan < log->seq + log->count) {
+    mu_LogLine *line = log_line(log, log->scan);
+    if (log_match(log, line, n)) {
+      int i = (log->match_first + log->match_count++) % log->line_cap;
+      log->matches[i] = log->scan;
+    }
+    budget -= line->len + 1;
+    log->scan++;
+  }
+}
+
+
+static void log_push(mu_Log *log, const char *str, int len) {
+  mu_LogLine *line;
+  int wrap, skip;
+  /* each line is stored with a null terminator after it, so text width
+  ** callbacks that stop at one never read past the ring */
+  len = mu_min(len, log->text_size - 1);
+  /* lines are kept contiguous, so one which doesn't fit before the end of
+  ** the ring goes at its start, skipping the bytes left */
+  wrap = log->head + len + 1 > log->text_size;
+  skip = wrap ? log->text_size - log->head : 0;
+  /* make room, dropping the oldest lines */
+  while (log->count > 0 && (log->count == log->line_cap ||
+      log->used + skip + len + 1 > log->text_size)
+  ) {
+    log_drop(log);
+  }
+  if (log->count == 0) { skip = 0; }
+  if (wrap || log->count == 0) { log->head = 0; }
+  line = log_line(log, log->seq + log->count);
+  memcpy(log->text + log->head, str, len);
+  log->text[log->head + len] = '\0';
+  line->start = log->head;
+  line->len = len;
+  log->head += len + 1;
+  log->used += skip + len + 1;
+  log->count++;
+  /* the line is checked now unless the filter is still catching up */
+  if (log->filter[0] && log->scan == log->seq + log->count - 1) {
+    log_scan(log, 1);
+  }
+}
+
+
+void mu_log_append(mu_Log *log, const char *text, int len) {
+  const char *end, *nl;
+  if (len < 0) { len = strlen(text); }
+  if (len > 0 && text[len - 1] == '\n') { len--; }
+  end = text + len;
+  for (;;) {
+    nl = memchr(text, '\n', end - text);
+    log_push(log, text, (nl ? nl : end) - text);
+    if (!nl) { break; }
+    text = nl + 1;
+  }
+}
+
+
+void mu_log_filter(mu_Log *log, const char *filter) {
+  int n = mu_min(strlen(filter), sizeof(log->filter) - 1);
+  if (!strncmp(log->filter, filter, sizeof(log->filter) - 1)) { return; }
+  memcpy(log->filter, filter, n);
+  log->filter[n] = '\0';
+  log->match_first = log->match_count = 0;
+  log->scan = log->seq;
+}
+
+
+void mu_log_view_ex(mu_Context *ctx, mu_Log *log, int opt) {
+  mu_Id id = mu_get_id_ptr(ctx, log);
+  mu_log_view_id(ctx, id, log, opt);
+}
+
+
+void mu_log_view_id(mu_Context *ctx, mu_Id id, mu_Log *log, int opt) {
+  mu_Font font = ctx->style->font;
+  mu_Color color = ctx->style->colors[MU_COLOR_TEXT];
+  int lh = text_height(ctx, font), pad = ctx->style->padding;
+  int i, n, first, last, follow;
+  mu_Rect r = mu_layout_next(ctx), clip, origin;
+  mu_Container *cnt = get_container(ctx, id, 0);
+
+  /* a changed filter is applied over several frames if the log is large */
+  if (log->filter[0]) { log_scan(log, MU_LOGSCAN_SIZE); }
+  n = log->filter[0] ? log->match_count : log->count;
+
+  /* keep to the newest line while the view was left scrolled to the bottom;
+  ** the content size is updated first so the scrollbar allows it */
+  follow = cnt->body.h == 0 ||
+    cnt->scroll.y >= cnt->content_size.y + pad * 2 - cnt->body.h;
+  cnt->content_size = mu_vec2(0, n * lh);
+  if (follow) { cnt->scroll.y = n * lh; }
+
+  /* only the visible lines are drawn */
+  mu_layout_set_next(ctx, r, 0);
+  mu_begin_panel_id(ctx, id, opt);
+  mu_layout_set_next(ctx, mu_rect(0, 0, 0, n * lh), 1);
+  origin = mu_layout_next(ctx);
+  clip = mu_get_clip_rect(ctx);
+  first = mu_clamp((clip.y - origin.y) / lh, 0, n);
+  last = mu_clamp((clip.y + clip.h - origin.y + lh - 1) / lh, first, n);
+  for (i = first; i < last; i++) {
+    int seq = log->filter[0]
+      ? log->matches[(log->match_first + i) % log->line_cap]
+      : log->seq + i;
+    mu_LogLine *line = log_line(log, seq);
+    mu_draw_text(ctx, font, log->text + line->start, line->len,
+      mu_vec2(origin.x, origin.y + i * lh), color);
+  }
+  mu_end_panel(ctx);
+}
+
+
+/*============================================================================
+** stats
+**============================================================================*/
+
+#ifdef MU_STATS
+
+static void stats_row(mu_Context *ctx, const char *label, const char *fmt,
+  int a, int b)
+{
+  char buf[32];
+  sprintf(buf, fmt, a, b);
+  mu_label(ctx, label);
+  mu_label(ctx, buf);
+}
+
+
+void mu_stats_window(mu_Context *ctx, const char *title, mu_Rect rect) {
+  static int widths[] = { -70, -1 };
+  static int root_widths[] = { -130, 65, -1 };
+  mu_Stats *st = &ctx->last_stats;
+  char buf[64];
+  int i, j, depth;
+
+  if (!mu_begin_window(ctx, title, rect)) { return; }
+
+  /* counters of the last finished frame */
+  if (mu_header_ex(ctx, "Frame", MU_OPT_EXPANDED)) {
+    mu_layout_row(ctx, 2, widths, 0);
+    stats_row(ctx, "Commands", "%d", st->commands, 0);
+    stats_row(ctx, "Command bytes", "%d", st->bytes, 0);
+    stats_row(ctx, "Clip pushes", "%d", st->clip_pushes, 0);
+    stats_row(ctx, "text_width calls", "%d", st->text_width_calls, 0);
+    stats_row(ctx, "text_height calls", "%d", st->text_height_calls, 0);
+    stats_row(ctx, "Pool lookups", "%d", st->pool_lookups, 0);
+    stats_row(ctx, "Pool hit rate", "%d%%", st->pool_lookups ?
+      (int) (100.0 * st->pool_hits / st->pool_lookups) : 100, 0);
+    stats_row(ctx, "Pool evictions", "%d", st->pool_evictions, 0);
+    stats_row(ctx, "Text lines drawn", "%d / %d",
+      st->text_lines_drawn, st->text_lines);
+  }
+
+  /* cost of each root container, nested ones indented under their parent */
+  if (mu_header_ex(ctx, "Roots", MU_OPT_EXPANDED)) {
+    mu_layout_row(ctx, 3, root_widths, 0);
+    mu_label(ctx, "Window");
+    mu_label(ctx, "Commands");
+    mu_label(ctx, "Bytes");
+    for (i = 0; i < st->root_count; i++) {
+      mu_RootStats *rs = &st->roots[i];
+      for (depth = 0, j = rs->parent; j >= 0; j = st->roots[j].parent) {
+        depth++;
+      }
+      depth = mu_min(depth, 8);
+      memset(buf, ' ', depth * 2);
+      strcpy(buf + depth * 2, rs->name);
+      mu_label(ctx, buf);
+      sprintf(buf, "%d", rs->commands);
+      mu_label(ctx, buf);
+      sprintf(buf, "%d", rs->bytes);
+      mu_label(ctx, buf);
+    }
+  }
+
+  /* deepest each stack has been since `mu_init()`, against its capacity */
+  if (mu_header_ex(ctx, "Stack peaks", MU_OPT_EXPANDED)) {
+    mu_layout_row(ctx, 2, widths, 0);
+    stats_row(ctx, "Root list", "%d / %d",
+      ctx->root_list.peak, ctx->root_list.cap);
+    stats_row(ctx, "Damage list", "%d / %d",
+      ctx->damage_list.peak, ctx->damage_list.cap);
+    stats_row(ctx, "Container stack", "%d / %d",
+      ctx->container_stack.peak, ctx->container_stack.cap);
+    stats_row(ctx, "Clip stack", "%d / %d",
+      ctx->clip_stack.peak, ctx->clip_stack.cap);
+    stats_row(ctx, "ID stack", "%d / %d",
+      ctx->id_stack.peak, ctx->id_stack.cap);
+    stats_row(ctx, "Layout stack", "%d / %d",
+      ctx->layout_stack.peak, ctx->layout_stack.cap);
+  }
+
+  mu_end_window(ctx);
+}
+
+#endif
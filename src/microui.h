@@ -11,6 +11,7 @@
 #define MU_VERSION "2.02"
 
 #define MU_COMMANDLIST_SIZE     (256 * 1024)
+#define MU_COMMANDCHUNK_SIZE    (64 * 1024)
 #define MU_ROOTLIST_SIZE        32
 #define MU_CONTAINERSTACK_SIZE  32
 #define MU_CLIPSTACK_SIZE       32
@@ -18,16 +19,28 @@
 #define MU_LAYOUTSTACK_SIZE     16
 #define MU_CONTAINERPOOL_SIZE   48
 #define MU_TREENODEPOOL_SIZE    48
+#define MU_DAMAGELIST_SIZE      16
+#define MU_EVENTQUEUE_SIZE      64
+#define MU_TEXTCACHE_SIZE       1024
+#define MU_TEXTCACHE_KEYSIZE    32
+#define MU_WRAPCACHE_SIZE       16
+#define MU_LOGFILTER_SIZE       64
+#define MU_LOGSCAN_SIZE         (256 * 1024)
 #define MU_MAX_WIDTHS           16
 #define MU_REAL                 float
 #define MU_REAL_FMT             "%.3g"
 #define MU_SLIDER_FMT           "%.2f"
 #define MU_MAX_FMT              127
 
-#define mu_stack(T, n)          struct { int idx; T items[n]; }
+#ifdef MU_STATS
+#define mu_stack(T)             struct { int idx, cap, peak; T *items; }
+#else
+#define mu_stack(T)             struct { int idx, cap; T *items; }
+#endif
 #define mu_min(a, b)            ((a) < (b) ? (a) : (b))
 #define mu_max(a, b)            ((a) > (b) ? (a) : (b))
 #define mu_clamp(x, a, b)       mu_min(b, mu_max(a, x))
+#define MU_POOL_TABLESIZE(len)  ((len) * 2)
 
 enum {
   MU_CLIP_PART = 1,
@@ -75,6 +88,11 @@ enum {
   MU_RES_CHANGE       = (1 << 2)
 };
 
+enum {
+  MU_FRAME_CHANGED    = (1 << 0),
+  MU_FRAME_ACTIVE     = (1 << 1)
+};
+
 enum {
   MU_OPT_ALIGNCENTER  = (1 << 0),
   MU_OPT_ALIGNRIGHT   = (1 << 1),
@@ -102,19 +120,42 @@ enum {
   MU_KEY_CTRL         = (1 << 1),
   MU_KEY_ALT          = (1 << 2),
   MU_KEY_BACKSPACE    = (1 << 3),
-  MU_KEY_RETURN       = (1 << 4)
+  MU_KEY_RETURN       = (1 << 4),
+  MU_KEY_DELETE       = (1 << 5),
+  MU_KEY_LEFT         = (1 << 6),
+  MU_KEY_RIGHT        = (1 << 7),
+  MU_KEY_UP           = (1 << 8),
+  MU_KEY_DOWN         = (1 << 9),
+  MU_KEY_HOME         = (1 << 10),
+  MU_KEY_END          = (1 << 11),
+  MU_KEY_PAGEUP       = (1 << 12),
+  MU_KEY_PAGEDOWN     = (1 << 13)
+};
+
+enum {
+  MU_EVENT_MOUSEMOVE = 1,
+  MU_EVENT_MOUSEDOWN,
+  MU_EVENT_MOUSEUP,
+  MU_EVENT_SCROLL,
+  MU_EVENT_KEYDOWN,
+  MU_EVENT_KEYUP,
+  MU_EVENT_TEXT
 };
 
 
 typedef struct mu_Context mu_Context;
+#ifdef MU_ID64
+typedef unsigned long long mu_Id;
+#else
 typedef unsigned mu_Id;
+#endif
 typedef MU_REAL mu_Real;
 typedef void* mu_Font;
 
 typedef struct { int x, y; } mu_Vec2;
 typedef struct { int x, y, w, h; } mu_Rect;
 typedef struct { unsigned char r, g, b, a; } mu_Color;
-typedef struct { mu_Id id; int last_update; } mu_PoolItem;
+typedef struct { mu_Id id; int last_update; int prev, next; } mu_PoolItem;
 
 typedef struct { int type, size; } mu_BaseCommand;
 typedef struct { mu_BaseCommand base; void *dst; } mu_JumpCommand;
@@ -133,6 +174,34 @@ typedef union {
   mu_IconCommand icon;
 } mu_Command;
 
+typedef struct { float x, y, u, v; mu_Color color; } mu_Vertex;
+typedef struct mu_QuadBlock mu_QuadBlock; /* defined in microui.c */
+
+typedef struct {
+  /* output: 4 vertices and 6 indices per quad, drawn as triangles */
+  mu_Vertex *vertices;
+  unsigned *indices;
+  int vertex_count, index_count;
+  int quad_cap;
+  mu_QuadBlock *quad_blocks; /* scratch: quads gathered before clipping */
+  /* atlas description, set by the user */
+  int atlas_width, atlas_height;
+  mu_Rect white;
+  mu_Rect (*icon_rect)(int id);
+  mu_Rect (*glyph_rect)(mu_Font font, int chr);
+} mu_DrawList;
+
+typedef struct mu_CommandChunk mu_CommandChunk;
+struct mu_CommandChunk { mu_CommandChunk *next; int size; }; /* data follows */
+
+typedef struct {
+  char *items;            /* data of the chunk being written */
+  int idx, size;          /* write offset and capacity of that chunk */
+  int total;              /* bytes written to the earlier chunks this frame */
+  mu_CommandChunk *head;  /* first chunk; further chunks are kept for reuse */
+  mu_CommandChunk *chunk; /* chunk being written */
+} mu_CommandList;
+
 typedef struct {
   mu_Rect body;
   mu_Rect next;
@@ -147,6 +216,42 @@ typedef struct {
   int indent;
 } mu_Layout;
 
+typedef struct {
+  int first, last; /* range of visible rows to process */
+  int count, height, start;
+} mu_Clipper;
+
+typedef struct {
+  const char *label;
+  int width;
+} mu_Column;
+
+typedef struct {
+  int type;
+  int value;      /* button or key */
+  mu_Vec2 pos;    /* mouse position, or the amount scrolled */
+  char text[16];  /* null-terminated; longer text is split between events */
+} mu_Event;
+
+/* events queued by the `mu_input_...()` functions; the first `applied` make
+** up the input of the current frame */
+typedef struct {
+  mu_Event *items;
+  int cap, first, count, applied;
+  int grown; /* `items` was allocated with `alloc` */
+} mu_EventQueue;
+
+typedef struct {
+  char *items; /* flattened commands of the window's last built segment */
+  int idx, size;
+  int valid, building;
+  unsigned version;
+  int opt;
+  mu_Rect rect;
+  mu_Vec2 scroll, content_size;
+  int root_idx, updated_focus;
+} mu_WindowCache;
+
 typedef struct {
   mu_Command *head, *tail;
   mu_Rect rect;
@@ -155,8 +260,117 @@ typedef struct {
   mu_Vec2 scroll;
   int zindex;
   int open;
+  mu_Rect draw_rect;
+  mu_Rect last_draw_rect;
+  mu_Id last_draw_hash;
+  int last_draw_frame;
+  int sort_frame, sort_zindex; /* frame and zindex it was last sorted with */
+  mu_WindowCache *cache; /* allocated by `mu_begin_window_cached()` */
 } mu_Container;
 
+typedef struct {
+  mu_PoolItem *items;
+  int *table; /* open addressing hash table of `MU_POOL_TABLESIZE(len)` slots */
+  int len;
+  int head, tail; /* least and most recently updated items */
+} mu_Pool;
+
+typedef struct {
+  mu_Id hash;
+  mu_Font font;
+  int len, width;
+  int last_used;
+  char text[MU_TEXTCACHE_KEYSIZE]; /* compared on lookup, so a hash collision
+                                   ** can't return another string's width */
+} mu_TextCacheItem;
+
+typedef struct {
+  mu_TextCacheItem items[MU_TEXTCACHE_SIZE];
+  int hits, misses;
+} mu_TextCache;
+
+typedef struct {
+  mu_Id id, hash;  /* identity and content of the text */
+  mu_Font font;
+  int len, width;  /* wrap width the lines were computed for */
+  int last_used;
+  int *words;      /* separator offset, width and separator width of each word */
+  int word_count, word_cap;
+  int *lines;      /* start and end offset of each line, the word following
+                  ** it, and the range of widths it is wrapped the same at */
+  int line_count, line_cap;
+  int *next_lines; /* lines of the next re-wrap, swapped with `lines` */
+  int next_line_cap;
+} mu_WrapCacheItem;
+
+typedef struct {
+  mu_WrapCacheItem items[MU_WRAPCACHE_SIZE];
+  int hits, rewraps, misses;
+} mu_WrapCache;
+
+/* state of a `mu_textedit()`; must be zero-initialised */
+typedef struct {
+  char *text;       /* gap buffer of `size` bytes, the gap at `gap` */
+  int size, gap, gap_len, len;
+  int *lines;       /* start offset of each line, kept as a gap buffer whose
+                    ** entries after the gap count from the end of the text */
+  int *widths;      /* width of each line, or -1 if not measured yet */
+  int line_size, line_gap, line_gap_len, line_count;
+  int cursor, anchor; /* byte offsets; the selection lies between them */
+  int cursor_x;     /* x kept when moving between lines, or -1 */
+  int max_width;    /* widest measured line; -1 if it must be found again */
+  mu_Font font;
+} mu_TextEdit;
+
+typedef struct { int start, len; } mu_LogLine;
+
+/* lines kept in caller-provided rings, see `mu_log_init()` */
+typedef struct {
+  char *text;
+  int text_size, head;
+  int used;         /* bytes from the oldest line to `head` */
+  mu_LogLine *lines;
+  int line_cap, first, count;
+  int seq;          /* sequence number of the oldest line */
+  int *matches;     /* ring of the sequence numbers of lines matching `filter` */
+  int match_first, match_count;
+  int scan;         /* sequence number of the next line to check against it */
+  char filter[MU_LOGFILTER_SIZE];
+} mu_Log;
+
+#ifdef MU_STATS
+typedef struct {
+  char name[32];  /* window title, truncated */
+  int parent;     /* index of the enclosing root container, or -1 */
+  int commands, bytes;
+} mu_RootStats;
+
+typedef struct {
+  int commands, bytes;
+  int clip_pushes;
+  int text_width_calls, text_height_calls;
+  int pool_lookups, pool_hits, pool_evictions;
+  int text_lines, text_lines_drawn; /* wrapped by `mu_text()` / not culled */
+  mu_RootStats *roots; /* in the order they were begun */
+  int root_count;
+  int current_root;
+} mu_Stats;
+#endif
+
+/* capacities for `mu_init_ex()`; fields left 0 use the MU_*_SIZE defaults */
+typedef struct {
+  int command_list_size; /* bytes; further chunks come from `alloc` if set */
+  int root_list_size;
+  int container_stack_size;
+  int clip_stack_size;
+  int id_stack_size;
+  int layout_stack_size;
+  int damage_list_size;
+  int container_pool_size;
+  int treenode_pool_size;
+  int event_queue_size;  /* grown with `alloc` if set */
+} mu_Config;
+
 typedef struct {
   mu_Font font;
   mu_Vec2 size;
@@ -174,9 +388,12 @@ struct mu_Context {
   int (*text_width)(mu_Font font, const char *str, int len);
   int (*text_height)(mu_Font font);
   void (*draw_frame)(mu_Context *ctx, mu_Rect rect, int colorid);
+  void* (*alloc)(mu_Context *ctx, void *ptr, int size);
   /* core state */
   mu_Style _style;
   mu_Style *style;
+  mu_TextCache *text_cache;
+  mu_WrapCache *wrap_cache;
   mu_Id hover;
   mu_Id focus;
   mu_Id last_id;
@@ -184,22 +401,29 @@ struct mu_Context {
   int last_zindex;
   int updated_focus;
   int frame;
+  int frame_flags;
+  int frame_delay; /* ms until another frame is needed, or -1 if none is */
   mu_Container *hover_root;
   mu_Container *next_hover_root;
   mu_Container *scroll_target;
   char number_edit_buf[MU_MAX_FMT];
   mu_Id number_edit;
+  mu_Id fork_hover, fork_focus; /* parent's state at `mu_fork()` */
+  int fork_zindex;
   /* stacks */
-  mu_stack(char, MU_COMMANDLIST_SIZE) command_list;
-  mu_stack(mu_Container*, MU_ROOTLIST_SIZE) root_list;
-  mu_stack(mu_Container*, MU_CONTAINERSTACK_SIZE) container_stack;
-  mu_stack(mu_Rect, MU_CLIPSTACK_SIZE) clip_stack;
-  mu_stack(mu_Id, MU_IDSTACK_SIZE) id_stack;
-  mu_stack(mu_Layout, MU_LAYOUTSTACK_SIZE) layout_stack;
+  mu_CommandList command_list;
+  mu_Rect command_clip;
+  mu_stack(mu_Container*) root_list;
+  mu_stack(mu_Container*) last_root_list;
+  mu_stack(mu_Rect) damage_list;
+  mu_stack(mu_Container*) container_stack;
+  mu_stack(mu_Rect) clip_stack;
+  mu_stack(mu_Id) id_stack;
+  mu_stack(mu_Layout) layout_stack;
   /* retained state pools */
-  mu_PoolItem container_pool[MU_CONTAINERPOOL_SIZE];
-  mu_Container containers[MU_CONTAINERPOOL_SIZE];
-  mu_PoolItem treenode_pool[MU_TREENODEPOOL_SIZE];
+  mu_Pool container_pool;
+  mu_Container *containers;
+  mu_Pool treenode_pool;
   /* input state */
   mu_Vec2 mouse_pos;
   mu_Vec2 last_mouse_pos;
@@ -210,6 +434,34 @@ struct mu_Context {
   int key_down;
   int key_pressed;
   char input_text[32];
+  mu_EventQueue event_queue;
+#ifdef MU_STATS
+  /* counters of the frame being built and of the last finished one; each
+  ** `mu_stack` also records its `peak` depth */
+  mu_Stats stats, last_stats;
+#endif
+#ifndef MU_SLIM
+  /* storage for the default capacities, used by `mu_init()` */
+  struct {
+    struct { mu_CommandChunk chunk; char data[MU_COMMANDLIST_SIZE]; } commands;
+    mu_Container *root_list[MU_ROOTLIST_SIZE];
+    mu_Container *last_root_list[MU_ROOTLIST_SIZE];
+    mu_Rect damage_list[MU_DAMAGELIST_SIZE];
+    mu_Container *container_stack[MU_CONTAINERSTACK_SIZE];
+    mu_Rect clip_stack[MU_CLIPSTACK_SIZE];
+    mu_Id id_stack[MU_IDSTACK_SIZE];
+    mu_Layout layout_stack[MU_LAYOUTSTACK_SIZE];
+    mu_PoolItem container_items[MU_CONTAINERPOOL_SIZE];
+    int container_table[MU_POOL_TABLESIZE(MU_CONTAINERPOOL_SIZE)];
+    mu_Container containers[MU_CONTAINERPOOL_SIZE];
+    mu_PoolItem treenode_items[MU_TREENODEPOOL_SIZE];
+    int treenode_table[MU_POOL_TABLESIZE(MU_TREENODEPOOL_SIZE)];
+    mu_Event event_queue[MU_EVENTQUEUE_SIZE];
+#ifdef MU_STATS
+    mu_RootStats root_stats[2][MU_ROOTLIST_SIZE];
+#endif
+  } _storage;
+#endif
 };
 
 
@@ -217,11 +469,20 @@ mu_Vec2 mu_vec2(int x, int y);
 mu_Rect mu_rect(int x, int y, int w, int h);
 mu_Color mu_color(int r, int g, int b, int a);
 
+#ifndef MU_SLIM
 void mu_init(mu_Context *ctx);
+#endif
+int mu_memory_size(const mu_Config *cfg);
+void mu_init_ex(mu_Context *ctx, const mu_Config *cfg, void *mem);
+void mu_deinit(mu_Context *ctx);
 void mu_begin(mu_Context *ctx);
-void mu_end(mu_Context *ctx);
+int mu_end(mu_Context *ctx);
+void mu_request_frame(mu_Context *ctx, int ms);
+void mu_fork(mu_Context *ctx, mu_Context *sub);
+void mu_join(mu_Context *ctx, mu_Context *sub);
 void mu_set_focus(mu_Context *ctx, mu_Id id);
 mu_Id mu_get_id(mu_Context *ctx, const void *data, int size);
+mu_Id mu_get_id_ptr(mu_Context *ctx, const void *ptr);
 void mu_push_id(mu_Context *ctx, const void *data, int size);
 void mu_pop_id(mu_Context *ctx);
 void mu_push_clip_rect(mu_Context *ctx, mu_Rect rect);
@@ -232,9 +493,11 @@ mu_Container* mu_get_current_container(mu_Context *ctx);
 mu_Container* mu_get_container(mu_Context *ctx, const char *name);
 void mu_bring_to_front(mu_Context *ctx, mu_Container *cnt);
 
-int mu_pool_init(mu_Context *ctx, mu_PoolItem *items, int len, mu_Id id);
-int mu_pool_get(mu_Context *ctx, mu_PoolItem *items, int len, mu_Id id);
-void mu_pool_update(mu_Context *ctx, mu_PoolItem *items, int idx);
+void mu_pool_setup(mu_Pool *pool, mu_PoolItem *items, int *table, int len);
+int mu_pool_init(mu_Context *ctx, mu_Pool *pool, mu_Id id);
+int mu_pool_get(mu_Context *ctx, mu_Pool *pool, mu_Id id);
+void mu_pool_update(mu_Context *ctx, mu_Pool *pool, int idx);
+void mu_pool_remove(mu_Context *ctx, mu_Pool *pool, int idx);
 
 void mu_input_mousemove(mu_Context *ctx, int x, int y);
 void mu_input_mousedown(mu_Context *ctx, int x, int y, int btn);
@@ -243,6 +506,7 @@ void mu_input_scroll(mu_Context *ctx, int x, int y);
 void mu_input_keydown(mu_Context *ctx, int key);
 void mu_input_keyup(mu_Context *ctx, int key);
 void mu_input_text(mu_Context *ctx, const char *text);
+int mu_next_event(mu_Context *ctx, mu_Event **event);
 
 mu_Command* mu_push_command(mu_Context *ctx, int type, int size);
 int mu_next_command(mu_Context *ctx, mu_Command **cmd);
@@ -251,6 +515,8 @@ void mu_draw_rect(mu_Context *ctx, mu_Rect rect, mu_Color color);
 void mu_draw_box(mu_Context *ctx, mu_Rect rect, mu_Color color);
 void mu_draw_text(mu_Context *ctx, mu_Font font, const char *str, int len, mu_Vec2 pos, mu_Color color);
 void mu_draw_icon(mu_Context *ctx, int id, mu_Rect rect, mu_Color color);
+void mu_drawlist_build(mu_Context *ctx, mu_DrawList *dl);
+void mu_drawlist_deinit(mu_Context *ctx, mu_DrawList *dl);
 
 void mu_layout_row(mu_Context *ctx, int items, const int *widths, int height);
 void mu_layout_width(mu_Context *ctx, int width);
@@ -267,30 +533,65 @@ void mu_update_control(mu_Context *ctx, mu_Id id, mu_Rect rect, int opt);
 
 #define mu_button(ctx, label)             mu_button_ex(ctx, label, 0, MU_OPT_ALIGNCENTER)
 #define mu_textbox(ctx, buf, bufsz)       mu_textbox_ex(ctx, buf, bufsz, 0)
+#define mu_textedit(ctx, te)              mu_textedit_ex(ctx, te, 0)
+#define mu_log_view(ctx, log)             mu_log_view_ex(ctx, log, 0)
 #define mu_slider(ctx, value, lo, hi)     mu_slider_ex(ctx, value, lo, hi, 0, MU_SLIDER_FMT, MU_OPT_ALIGNCENTER)
 #define mu_number(ctx, value, step)       mu_number_ex(ctx, value, step, MU_SLIDER_FMT, MU_OPT_ALIGNCENTER)
 #define mu_header(ctx, label)             mu_header_ex(ctx, label, 0)
 #define mu_begin_treenode(ctx, label)     mu_begin_treenode_ex(ctx, label, 0)
 #define mu_begin_window(ctx, title, rect) mu_begin_window_ex(ctx, title, rect, 0)
 #define mu_begin_panel(ctx, name)         mu_begin_panel_ex(ctx, name, 0)
+#define mu_table(ctx, name, columns, ncolumns, rows, cell, udata) \
+  mu_table_ex(ctx, name, columns, ncolumns, rows, cell, udata, 0)
 
 void mu_text(mu_Context *ctx, const char *text);
 void mu_label(mu_Context *ctx, const char *text);
 int mu_button_ex(mu_Context *ctx, const char *label, int icon, int opt);
+int mu_button_id(mu_Context *ctx, mu_Id id, const char *label, int icon, int opt);
 int mu_checkbox(mu_Context *ctx, const char *label, int *state);
+int mu_checkbox_id(mu_Context *ctx, mu_Id id, const char *label, int *state);
 int mu_textbox_raw(mu_Context *ctx, char *buf, int bufsz, mu_Id id, mu_Rect r, int opt);
 int mu_textbox_ex(mu_Context *ctx, char *buf, int bufsz, int opt);
+int mu_textedit_ex(mu_Context *ctx, mu_TextEdit *te, int opt);
+int mu_textedit_id(mu_Context *ctx, mu_Id id, mu_TextEdit *te, int opt);
+void mu_textedit_set(mu_Context *ctx, mu_TextEdit *te, const char *text, int len);
+void mu_textedit_insert(mu_Context *ctx, mu_TextEdit *te, const char *text, int len);
+const char* mu_textedit_text(mu_Context *ctx, mu_TextEdit *te);
+void mu_textedit_deinit(mu_Context *ctx, mu_TextEdit *te);
+void mu_log_init(mu_Log *log, char *text, int text_size, mu_LogLine *lines, int *matches, int line_cap);
+void mu_log_clear(mu_Log *log);
+void mu_log_append(mu_Log *log, const char *text, int len);
+void mu_log_filter(mu_Log *log, const char *filter);
+void mu_log_view_ex(mu_Context *ctx, mu_Log *log, int opt);
+void mu_log_view_id(mu_Context *ctx, mu_Id id, mu_Log *log, int opt);
 int mu_slider_ex(mu_Context *ctx, mu_Real *value, mu_Real low, mu_Real high, mu_Real step, const char *fmt, int opt);
+int mu_slider_id(mu_Context *ctx, mu_Id id, mu_Real *value, mu_Real low, mu_Real high, mu_Real step, const char *fmt, int opt);
 int mu_number_ex(mu_Context *ctx, mu_Real *value, mu_Real step, const char *fmt, int opt);
+int mu_number_id(mu_Context *ctx, mu_Id id, mu_Real *value, mu_Real step, const char *fmt, int opt);
 int mu_header_ex(mu_Context *ctx, const char *label, int opt);
+int mu_header_id(mu_Context *ctx, mu_Id id, const char *label, int opt);
 int mu_begin_treenode_ex(mu_Context *ctx, const char *label, int opt);
+int mu_begin_treenode_id(mu_Context *ctx, mu_Id id, const char *label, int opt);
 void mu_end_treenode(mu_Context *ctx);
 int mu_begin_window_ex(mu_Context *ctx, const char *title, mu_Rect rect, int opt);
+int mu_begin_window_id(mu_Context *ctx, mu_Id id, const char *title, mu_Rect rect, int opt);
 void mu_end_window(mu_Context *ctx);
+int mu_begin_window_cached(mu_Context *ctx, const char *title, mu_Rect rect, int opt, unsigned version);
 void mu_open_popup(mu_Context *ctx, const char *name);
 int mu_begin_popup(mu_Context *ctx, const char *name);
 void mu_end_popup(mu_Context *ctx);
 void mu_begin_panel_ex(mu_Context *ctx, const char *name, int opt);
+void mu_begin_panel_id(mu_Context *ctx, mu_Id id, int opt);
 void mu_end_panel(mu_Context *ctx);
+void mu_begin_clipper(mu_Context *ctx, mu_Clipper *clipper, int count, int height);
+void mu_end_clipper(mu_Context *ctx, mu_Clipper *clipper);
+int mu_table_ex(mu_Context *ctx, const char *name, mu_Column *columns,
+  int ncolumns, int rows,
+  void (*cell)(mu_Context *ctx, void *udata, int row, int col, mu_Rect rect),
+  void *udata, int opt);
+
+#ifdef MU_STATS
+void mu_stats_window(mu_Context *ctx, const char *title, mu_Rect rect);
+#endif
 
 #endif